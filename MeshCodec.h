@@ -0,0 +1,318 @@
+/**********************************************************************************
+ * MeshCodec.h
+ *
+ * .mesh section 的编解码, 转换器与运行时共用.
+ *
+ **********************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// x86 上的 SIMD 内核与 CPUID 检测只在这里定义一次, 转换器 (main.cpp) 也经由本头文件取得 MC_X86 / MC_TARGET
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MC_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MC_TARGET(x)
+#else
+#include <cpuid.h>
+#define MC_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+// ---- 索引: zigzag 差分 + Stream VByte (ENCODING_INDEX_DELTA_VBYTE) ----
+//
+// 每个索引与前一个索引作差 (首个与 0), zigzag 后按 1..4 字节存放.
+// 布局: 控制字节 [(n + 3) / 4], 每字节 4 个 2-bit 长度 (低位在前, 值 = 字节数 - 1); 随后是各值的小端字节.
+// 经过缓存优化的三角形列表相邻索引很接近, 大多数值只占 1 字节.
+
+inline uint32_t ZigZagEncode(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline uint32_t ZigZagDecode(uint32_t v) { return (v >> 1) ^ (0u - (v & 1)); }
+
+inline std::vector<unsigned char> EncodeIndices(const uint32_t* indices, size_t count) {
+    size_t controlBytes = (count + 3) / 4;
+    std::vector<unsigned char> out(controlBytes, 0);
+    out.reserve(controlBytes + count * 2);
+    uint32_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t v = ZigZagEncode((int32_t)(indices[i] - prev));
+        prev = indices[i];
+        unsigned len = v < (1u << 8) ? 1 : v < (1u << 16) ? 2 : v < (1u << 24) ? 3 : 4;
+        out[i / 4] |= (unsigned char)((len - 1) << ((i % 4) * 2));
+        for (unsigned b = 0; b < len; ++b) out.push_back((unsigned char)(v >> (b * 8)));
+    }
+    return out;
+}
+
+// 解码到 out[count], 数据不完整时返回 false
+inline bool DecodeIndicesScalar(const unsigned char* data, size_t size, uint32_t* out, size_t count) {
+    size_t controlBytes = (count + 3) / 4;
+    if (size < controlBytes) return false;
+    const unsigned char* ctrl = data;
+    const unsigned char* p = data + controlBytes;
+    const unsigned char* end = data + size;
+    uint32_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+        unsigned len = ((ctrl[i / 4] >> ((i % 4) * 2)) & 3) + 1;
+        if ((size_t)(end - p) < len) return false;
+        uint32_t v = 0;
+        for (unsigned b = 0; b < len; ++b) v |= (uint32_t)p[b] << (b * 8);
+        p += len;
+        prev += ZigZagDecode(v);
+        out[i] = prev;
+    }
+    return true;
+}
+
+#if defined(MC_X86)
+// 每个控制字节对应一个 pshufb 掩码, 把 4 个变长值展开到 4 个 32 位通道
+struct VByteTables {
+    alignas(16) unsigned char shuffle[256][16];
+    unsigned char length[256];
+    VByteTables() {
+        for (unsigned c = 0; c < 256; ++c) {
+            unsigned at = 0;
+            for (unsigned lane = 0; lane < 4; ++lane) {
+                unsigned len = ((c >> (lane * 2)) & 3) + 1;
+                for (unsigned b = 0; b < 4; ++b) shuffle[c][lane * 4 + b] = b < len ? (unsigned char)(at + b) : 0x80;
+                at += len;
+            }
+            length[c] = (unsigned char)at;
+        }
+    }
+};
+
+inline const VByteTables& GetVByteTables() {
+    static const VByteTables tables;
+    return tables;
+}
+
+MC_TARGET("ssse3")
+inline bool DecodeIndicesSSSE3(const unsigned char* data, size_t size, uint32_t* out, size_t count) {
+    size_t controlBytes = (count + 3) / 4;
+    if (size < controlBytes) return false;
+    const VByteTables& t = GetVByteTables();
+    const unsigned char* p = data + controlBytes;
+    const unsigned char* end = data + size;
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i prev = _mm_setzero_si128();
+    size_t g = 0, groups = count / 4;
+    // 每组最多读 16 字节, 剩余不足 16 字节时交给标量尾部
+    for (; g < groups && end - p >= 16; ++g) {
+        unsigned c = data[g];
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p), _mm_load_si128((const __m128i*)t.shuffle[c]));
+        p += t.length[c];
+        v = _mm_xor_si128(_mm_srli_epi32(v, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, one)));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi32(v, _mm_shuffle_epi32(prev, 0xFF));
+        _mm_storeu_si128((__m128i*)(out + g * 4), v);
+        prev = v;
+    }
+    uint32_t last = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi32(prev, 0xFF));
+    for (size_t i = g * 4; i < count; ++i) {
+        unsigned len = ((data[i / 4] >> ((i % 4) * 2)) & 3) + 1;
+        if ((size_t)(end - p) < len) return false;
+        uint32_t v = 0;
+        for (unsigned b = 0; b < len; ++b) v |= (uint32_t)p[b] << (b * 8);
+        p += len;
+        last += ZigZagDecode(v);
+        out[i] = last;
+    }
+    return true;
+}
+
+inline bool CpuHasSSSE3() {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 1);
+    return (r[2] & (1 << 9)) != 0;
+#else
+    unsigned a, b, c, d;
+    return __get_cpuid(1, &a, &b, &c, &d) && (c & bit_SSSE3);
+#endif
+}
+#endif
+
+inline bool DecodeIndices(const unsigned char* data, size_t size, uint32_t* out, size_t count) {
+#if defined(MC_X86)
+    static const bool ssse3 = CpuHasSSSE3();
+    if (ssse3) return DecodeIndicesSSSE3(data, size, out, count);
+#endif
+    return DecodeIndicesScalar(data, size, out, count);
+}
+
+// ---- 顶点: 字节平面差分 + 分组位宽打包 (ENCODING_VERTEX_BYTEPLANE) ----
+//
+// 顶点按 16 个一块. 块内把 stride 个字节位置各自看成一个 "字节平面" (16 个顶点的同一字节),
+// 每个字节与前一个顶点的同一字节按字节相减 (跨块延续, 首个与 0), zigzag 后按整个平面的最大值
+// 选 0 / 2 / 4 / 8 位存放. 浮点的符号/指数/高位尾数字节在相邻顶点间变化很小, 大多落在 0~4 位.
+// 布局: 每块 [控制字节 (stride + 3) / 4, 每平面 2 bit: 0 = 0 位, 1 = 2 位, 2 = 4 位, 3 = 8 位][各平面数据 0/4/8/16 字节].
+// 2 位平面中第 k 个值位于字节 k % 4 的第 2 * (k / 4) 位, 4 位平面中位于字节 k % 8 的第 4 * (k / 8) 位,
+// 这样 SIMD 解码只需整体移位而不需要逐字节移位. 末尾不足 16 个顶点的块按最后一个顶点补齐.
+
+const size_t VERTEX_BLOCK = 16;
+
+inline unsigned char ZigZagByte(unsigned char d) { return (unsigned char)((d << 1) ^ (unsigned char)((signed char)d >> 7)); }
+inline unsigned char UnZigZagByte(unsigned char z) { return (unsigned char)((z >> 1) ^ (0u - (z & 1))); }
+
+inline std::vector<unsigned char> EncodeVertices(const unsigned char* vertices, size_t count, size_t stride) {
+    std::vector<unsigned char> out;
+    std::vector<unsigned char> last(stride, 0);
+    const size_t controlBytes = (stride + 3) / 4;
+    unsigned char plane[VERTEX_BLOCK];
+    for (size_t base = 0; base < count; base += VERTEX_BLOCK) {
+        size_t ctrlAt = out.size();
+        out.resize(out.size() + controlBytes, 0);
+        for (size_t b = 0; b < stride; ++b) {
+            unsigned char prev = last[b], maxv = 0;
+            for (size_t k = 0; k < VERTEX_BLOCK; ++k) {
+                size_t v = std::min(base + k, count - 1);
+                unsigned char cur = vertices[v * stride + b];
+                plane[k] = ZigZagByte((unsigned char)(cur - prev));
+                prev = cur;
+                maxv = std::max(maxv, plane[k]);
+            }
+            last[b] = prev;
+            unsigned mode = maxv == 0 ? 0 : maxv < 4 ? 1 : maxv < 16 ? 2 : 3;
+            out[ctrlAt + b / 4] |= (unsigned char)(mode << ((b % 4) * 2));
+            if (mode == 1) {
+                unsigned char packed[4] = {};
+                for (size_t k = 0; k < VERTEX_BLOCK; ++k) packed[k % 4] |= (unsigned char)(plane[k] << (2 * (k / 4)));
+                out.insert(out.end(), packed, packed + 4);
+            }
+            else if (mode == 2) {
+                unsigned char packed[8] = {};
+                for (size_t k = 0; k < VERTEX_BLOCK; ++k) packed[k % 8] |= (unsigned char)(plane[k] << (4 * (k / 8)));
+                out.insert(out.end(), packed, packed + 8);
+            }
+            else if (mode == 3) out.insert(out.end(), plane, plane + VERTEX_BLOCK);
+        }
+    }
+    return out;
+}
+
+// 从第 base 个顶点 (块边界) 开始标量解码到末尾, last[stride] 为前一个顶点的字节, 解码时更新
+inline bool DecodeVertexBlocksScalar(const unsigned char* p, const unsigned char* end, unsigned char* out, size_t base, size_t count,
+                                     size_t stride, unsigned char* last) {
+    static const unsigned planeBytes[4] = { 0, 4, 8, 16 };
+    const size_t controlBytes = (stride + 3) / 4;
+    for (; base < count; base += VERTEX_BLOCK) {
+        if ((size_t)(end - p) < controlBytes) return false;
+        const unsigned char* ctrl = p;
+        p += controlBytes;
+        size_t n = std::min(VERTEX_BLOCK, count - base);
+        for (size_t b = 0; b < stride; ++b) {
+            unsigned mode = (ctrl[b / 4] >> ((b % 4) * 2)) & 3;
+            if ((size_t)(end - p) < planeBytes[mode]) return false;
+            unsigned char prev = last[b];
+            for (size_t k = 0; k < VERTEX_BLOCK; ++k) {
+                unsigned char z = mode == 0 ? 0 : mode == 1 ? (p[k % 4] >> (2 * (k / 4))) & 3 : mode == 2 ? (p[k % 8] >> (4 * (k / 8))) & 15 : p[k];
+                prev = (unsigned char)(prev + UnZigZagByte(z));
+                if (k < n) out[(base + k) * stride + b] = prev;
+            }
+            last[b] = prev;
+            p += planeBytes[mode];
+        }
+    }
+    return true;
+}
+
+inline bool DecodeVerticesScalar(const unsigned char* data, size_t size, unsigned char* out, size_t count, size_t stride) {
+    std::vector<unsigned char> last(stride, 0);
+    return DecodeVertexBlocksScalar(data, data + size, out, 0, count, stride, last.data());
+}
+
+#if defined(MC_X86)
+MC_TARGET("ssse3")
+inline __m128i DecodeVertexPlaneSSSE3(const unsigned char*& p, unsigned mode, __m128i prev) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i z;
+    if (mode == 0) z = zero;
+    else if (mode == 1) {
+        uint32_t x;
+        std::memcpy(&x, p, 4);
+        __m128i t = _mm_set1_epi32((int)x);
+        z = _mm_unpacklo_epi64(_mm_unpacklo_epi32(t, _mm_srli_epi32(t, 2)), _mm_unpacklo_epi32(_mm_srli_epi32(t, 4), _mm_srli_epi32(t, 6)));
+        z = _mm_and_si128(z, _mm_set1_epi8(3));
+        p += 4;
+    }
+    else if (mode == 2) {
+        __m128i t = _mm_loadl_epi64((const __m128i*)p);
+        z = _mm_and_si128(_mm_unpacklo_epi64(t, _mm_srli_epi64(t, 4)), _mm_set1_epi8(15));
+        p += 8;
+    }
+    else {
+        z = _mm_loadu_si128((const __m128i*)p);
+        p += 16;
+    }
+    // 反 zigzag, 再做 16 个字节的前缀和, 加上前一个顶点的字节
+    __m128i d = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(z, 1), _mm_set1_epi8(0x7F)), _mm_sub_epi8(zero, _mm_and_si128(z, _mm_set1_epi8(1))));
+    d = _mm_add_epi8(d, _mm_slli_si128(d, 1));
+    d = _mm_add_epi8(d, _mm_slli_si128(d, 2));
+    d = _mm_add_epi8(d, _mm_slli_si128(d, 4));
+    d = _mm_add_epi8(d, _mm_slli_si128(d, 8));
+    return _mm_add_epi8(d, _mm_shuffle_epi8(prev, _mm_set1_epi8(15)));
+}
+
+// stride 须为 4 的倍数: 每 4 个平面转置成 16 个顶点的一个 32 位分量, 再分散写出
+MC_TARGET("ssse3")
+inline bool DecodeVerticesSSSE3(const unsigned char* data, size_t size, unsigned char* out, size_t count, size_t stride) {
+    if (stride % 4 != 0) return DecodeVerticesScalar(data, size, out, count, stride);
+    // 各平面上一块解码出的 16 个字节
+    std::vector<unsigned char> last(stride * 16, 0), tail(VERTEX_BLOCK * stride);
+    const size_t controlBytes = (stride + 3) / 4;
+    const size_t maxBlockBytes = controlBytes + VERTEX_BLOCK * stride;
+    const unsigned char* p = data;
+    const unsigned char* end = data + size;
+    size_t base = 0;
+    // 剩余数据足够一个最大块时才走 SIMD (不越界读), 否则 (只会在末尾几块) 交给标量
+    for (; base < count && (size_t)(end - p) >= maxBlockBytes; base += VERTEX_BLOCK) {
+        size_t n = std::min(VERTEX_BLOCK, count - base);
+        const unsigned char* ctrl = p;
+        p += controlBytes;
+        unsigned char* dst = n == VERTEX_BLOCK ? out + base * stride : tail.data();
+        for (size_t b = 0; b < stride; b += 4) {
+            unsigned c = ctrl[b / 4];
+            __m128i* prev = (__m128i*)&last[b * 16];
+            __m128i p0 = DecodeVertexPlaneSSSE3(p, c & 3, _mm_loadu_si128(prev + 0));
+            __m128i p1 = DecodeVertexPlaneSSSE3(p, (c >> 2) & 3, _mm_loadu_si128(prev + 1));
+            __m128i p2 = DecodeVertexPlaneSSSE3(p, (c >> 4) & 3, _mm_loadu_si128(prev + 2));
+            __m128i p3 = DecodeVertexPlaneSSSE3(p, (c >> 6) & 3, _mm_loadu_si128(prev + 3));
+            _mm_storeu_si128(prev + 0, p0);
+            _mm_storeu_si128(prev + 1, p1);
+            _mm_storeu_si128(prev + 2, p2);
+            _mm_storeu_si128(prev + 3, p3);
+            __m128i lo01 = _mm_unpacklo_epi8(p0, p1), hi01 = _mm_unpackhi_epi8(p0, p1);
+            __m128i lo23 = _mm_unpacklo_epi8(p2, p3), hi23 = _mm_unpackhi_epi8(p2, p3);
+            __m128i w[4] = { _mm_unpacklo_epi16(lo01, lo23), _mm_unpackhi_epi16(lo01, lo23), _mm_unpacklo_epi16(hi01, hi23), _mm_unpackhi_epi16(hi01, hi23) };
+            unsigned char* o = dst + b;
+            for (int q = 0; q < 4; ++q) {
+                for (int lane = 0; lane < 4; ++lane, o += stride) {
+                    uint32_t x = (uint32_t)_mm_cvtsi128_si32(w[q]);
+                    std::memcpy(o, &x, 4);
+                    w[q] = _mm_srli_si128(w[q], 4);
+                }
+            }
+        }
+        if (n < VERTEX_BLOCK) std::memcpy(out + base * stride, tail.data(), n * stride);
+    }
+    if (base >= count) return true;
+    for (size_t b = 0; b < stride; ++b) tail[b] = last[b * 16 + 15];
+    return DecodeVertexBlocksScalar(p, end, out, base, count, stride, tail.data());
+}
+#endif
+
+inline bool DecodeVertices(const unsigned char* data, size_t size, unsigned char* out, size_t count, size_t stride) {
+#if defined(MC_X86)
+    static const bool ssse3 = CpuHasSSSE3();
+    if (ssse3) return DecodeVerticesSSSE3(data, size, out, count, stride);
+#endif
+    return DecodeVerticesScalar(data, size, out, count, stride);
+}
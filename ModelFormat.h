@@ -0,0 +1,276 @@
+/**********************************************************************************
+ * ModelFormat.h
+ *
+ * ModelConverter 输出的二进制文件布局, 转换器与运行时共用.
+ *
+ **********************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+// ---- .mesh ----
+//
+// MeshFileHeader
+// VertexAttribute[attributeCount]   (attributeOffset)
+// MeshSection[sectionCount]         (sectionOffset)
+// 各 section 数据, 每段起始按 MESH_SECTION_ALIGNMENT 对齐
+//
+// 所有 offset 均从文件开头算起, 小端序.
+
+const uint32_t MESH_MAGIC = 0x4853454D;  // "MESH"
+const uint16_t MESH_VERSION = 2;
+const uint32_t MESH_SECTION_ALIGNMENT = 16;
+
+const uint32_t MESH_FLAG_SPLIT_STREAMS = 1u << 0;  // 顶点按 位置 / 着色 / 蒙皮 拆成多个 VERTEX section
+
+struct MeshFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;       // sizeof(MeshFileHeader), 便于以后在末尾追加字段
+    uint32_t flags;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t materialIndex;
+    uint32_t influenceCount;   // 每顶点骨骼影响数, 无蒙皮时仍为顶点布局中的槽位数
+    float    aabbMin[3];
+    float    aabbMax[3];
+    float    sphereCenter[3];
+    float    sphereRadius;
+    uint32_t attributeCount;
+    uint32_t attributeOffset;
+    uint32_t sectionCount;
+    uint32_t sectionOffset;
+};
+
+enum MeshAttributeSemantic : uint16_t {
+    ATTR_POSITION = 0,
+    ATTR_TEXCOORD0 = 1,
+    ATTR_NORMAL = 2,
+    ATTR_TANGENT = 3,
+    ATTR_BONE_INDICES = 4,
+    ATTR_BONE_WEIGHTS = 5,
+};
+
+enum MeshComponentType : uint8_t {
+    COMPONENT_FLOAT32 = 0,
+    COMPONENT_SINT32 = 1,
+    COMPONENT_UINT32 = 2,
+};
+
+// 顶点属性: 位于 section 号 section 中, 第 i 个顶点的数据在 section.offset + offset + i * stride
+struct VertexAttribute {
+    uint16_t semantic;
+    uint8_t  componentType;
+    uint8_t  componentCount;
+    uint32_t section;
+    uint32_t offset;
+    uint32_t stride;
+};
+
+enum MeshSectionType : uint32_t {
+    SECTION_VERTEX = 0,       // 顶点数据 (由 VertexAttribute 描述)
+    SECTION_INDEX = 1,        // uint32 三角形列表
+    SECTION_BATCHES = 2,      // MeshBatch[]
+    SECTION_PALETTE = 3,      // uint32 调色板下标 -> 全局骨骼 ID
+    SECTION_BONE_BOUNDS = 4,  // BoneBounds[]
+    SECTION_SUBMESHES = 5,    // SubMesh[], 仅合并后的网格
+};
+
+enum MeshSectionEncoding : uint32_t {
+    ENCODING_RAW = 0,
+    ENCODING_INDEX_DELTA_VBYTE = 1,   // 仅 INDEX: zigzag 差分 + Stream VByte, 见 MeshCodec.h
+    ENCODING_VERTEX_BYTEPLANE = 2,    // 仅 VERTEX: 字节平面差分 + 0/2/4/8 位分组打包, 见 MeshCodec.h
+};
+
+struct MeshSection {
+    uint32_t type;
+    uint32_t encoding;
+    uint32_t offset;
+    uint32_t size;             // 文件中的字节数
+    uint32_t elementCount;
+    uint32_t stride;           // 解码后每个元素的字节数
+};
+
+// 骨骼调色板子批次: 顶点/索引按批次连续, boneIDs 为 palette 内的局部下标
+struct MeshBatch {
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+    uint32_t paletteOffset;
+    uint32_t paletteCount;
+};
+
+// 骨骼空间 (绑定姿态, 经 offset 变换) 下受该骨骼影响的顶点包围盒, 运行时乘当前骨骼矩阵即得保守包围盒
+struct BoneBounds {
+    uint32_t boneId;
+    float    min[3];
+    float    max[3];
+};
+
+// 合并网格中一个源网格 (scene 内 aiMesh 下标) 的范围, 索引已加上 vertexOffset
+struct SubMesh {
+    uint32_t sourceMesh;
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+};
+
+// ---- materials.bin ----
+//
+// MaterialFileHeader
+// MaterialRecord[materialCount]     (recordOffset)
+// 字符串池                          (stringOffset, stringSize 字节), 以 '\0' 结尾的 UTF-8 字符串
+//
+// 字符串以其在池中的字节偏移引用, MATERIAL_NO_STRING 表示不存在.
+
+const uint32_t MATERIAL_MAGIC = 0x4C54414D;  // "MATL"
+const uint16_t MATERIAL_VERSION = 1;
+const uint32_t MATERIAL_NO_STRING = 0xFFFFFFFFu;
+
+struct MaterialFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;       // sizeof(MaterialFileHeader)
+    uint32_t materialCount;
+    uint32_t recordOffset;
+    uint32_t stringOffset;
+    uint32_t stringSize;
+};
+
+// 纹理槽, 顺序与转换器的 TEXTURE_SLOTS 一致
+enum MaterialTextureSlot : uint32_t {
+    MATERIAL_TEXTURE_DIFFUSE = 0,
+    MATERIAL_TEXTURE_BASE_COLOR = 1,
+    MATERIAL_TEXTURE_NORMAL = 2,
+    MATERIAL_TEXTURE_METALLIC = 3,
+    MATERIAL_TEXTURE_ROUGHNESS = 4,
+    MATERIAL_TEXTURE_EMISSIVE = 5,
+    MATERIAL_TEXTURE_OCCLUSION = 6,
+    MATERIAL_TEXTURE_SLOT_COUNT = 7,
+};
+
+struct MaterialRecord {
+    uint32_t name;                                   // 合并前第一个同内容材质的名字
+    float    diffuseColor[4];
+    uint32_t textures[MATERIAL_TEXTURE_SLOT_COUNT];  // 纹理文件名 (相对输出目录)
+};
+
+// ---- skeleton.bin ----
+//
+// SkeletonFileHeader
+// int32  parents[boneCount]                     (parentOffset)     父骨骼下标总小于自身, 根为 -1
+// uint32 names[boneCount]                       (nameOffset)       字符串池偏移
+// float  inverseBind[12][paddedCount]           (inverseBindOffset) 3x4 行主序矩阵 SoA: 分量 k = row * 4 + col 的所有骨骼连续
+// float  bindLocal[12][paddedCount]             (bindLocalOffset)   相对父骨骼的绑定姿态; 根骨骼为模型空间绑定姿态 (= bindGlobal)
+// float  bindGlobal[12][paddedCount]            (bindGlobalOffset)  模型空间绑定姿态 (inverseBind 的逆)
+// SkeletonNameSlot nameTable[hashCapacity]      (hashOffset)       HashBoneName 开放寻址, 线性探测
+// 字符串池                                      (stringOffset, stringSize 字节)
+//
+// 矩阵分量数组起始按 SKELETON_SIMD_ALIGNMENT 对齐, paddedCount 为 boneCount 向上取整到 SKELETON_SIMD_WIDTH,
+// 补齐部分为单位矩阵. 平移已乘 G_SCALE_FACTOR.
+// 根骨骼的非骨骼祖先变换已并入其 bindLocal, 按 parents 顺序逐级累乘 bindLocal 即得到 bindGlobal.
+
+const uint32_t SKELETON_MAGIC = 0x4C454B53;  // "SKEL"
+const uint16_t SKELETON_VERSION = 1;
+const uint32_t SKELETON_SIMD_WIDTH = 8;
+const uint32_t SKELETON_SIMD_ALIGNMENT = 32;
+const uint32_t SKELETON_NO_BONE = 0xFFFFFFFFu;
+
+struct SkeletonFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;       // sizeof(SkeletonFileHeader)
+    uint32_t boneCount;
+    uint32_t paddedCount;
+    uint32_t parentOffset;
+    uint32_t nameOffset;
+    uint32_t inverseBindOffset;
+    uint32_t bindLocalOffset;
+    uint32_t bindGlobalOffset;
+    uint32_t hashOffset;
+    uint32_t hashCapacity;     // 2 的幂, 至少为 boneCount 的两倍
+    uint32_t stringOffset;
+    uint32_t stringSize;
+};
+
+struct SkeletonNameSlot {
+    uint32_t hash;
+    uint32_t bone;             // 空槽为 SKELETON_NO_BONE
+};
+
+// 骨骼名哈希 (FNV-1a 32 位), 转换器与运行时必须一致
+inline uint32_t HashBoneName(const char* name) {
+    uint32_t h = 2166136261u;
+    for (; *name; ++name) h = (h ^ (unsigned char)*name) * 16777619u;
+    return h;
+}
+
+// ---- nodes.bin ----
+//
+// NodeFileHeader
+// NodeRecord[nodeCount]             (nodeOffset)     前序排列, parent 总小于自身下标, 根为 -1
+// NodeMeshRef[meshRefCount]         (meshRefOffset)  各节点引用的网格, 由 NodeRecord.firstMesh / meshCount 索引
+// 字符串池                          (stringOffset, stringSize 字节)
+//
+// 按数组顺序 world[i] = world[parent] * local[i] 一次线性遍历即可得到所有节点的世界变换. 平移已乘 G_SCALE_FACTOR.
+
+const uint32_t NODE_MAGIC = 0x45444F4E;  // "NODE"
+const uint16_t NODE_VERSION = 1;
+const uint32_t NODE_WHOLE_MESH = 0xFFFFFFFFu;
+
+struct NodeFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;       // sizeof(NodeFileHeader)
+    uint32_t nodeCount;
+    uint32_t nodeOffset;
+    uint32_t meshRefCount;
+    uint32_t meshRefOffset;
+    uint32_t stringOffset;
+    uint32_t stringSize;
+};
+
+// 局部变换 = T * R * S
+struct NodeRecord {
+    int32_t  parent;
+    uint32_t name;             // 字符串池偏移
+    float    translation[3];
+    float    rotation[4];      // 四元数 x, y, z, w
+    float    scale[3];
+    uint32_t firstMesh;
+    uint32_t meshCount;
+};
+
+// mesh 为输出网格 (mesh_N.mesh) 的 N; 合并网格只画其中第 submesh 个 SubMesh, 未合并时为 NODE_WHOLE_MESH
+struct NodeMeshRef {
+    uint32_t mesh;
+    uint32_t submesh;
+};
+
+// ---- instances.bin (--bake-transforms) ----
+//
+// InstanceFileHeader
+// MeshInstance[instanceCount]       (instanceOffset)  按 mesh 升序, 同一网格的实例连续, 可直接作为实例缓冲
+//
+// 静态网格的全部绘制: 只被一个节点引用的网格已把世界变换烘焙进顶点, world 为单位矩阵;
+// 被多个节点引用的网格保持局部空间, 每个引用节点一个实例. 运行时不需要遍历节点树.
+
+const uint32_t INSTANCE_MAGIC = 0x54534E49;  // "INST"
+const uint16_t INSTANCE_VERSION = 1;
+
+struct InstanceFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;       // sizeof(InstanceFileHeader)
+    uint32_t instanceCount;
+    uint32_t instanceOffset;
+};
+
+struct MeshInstance {
+    uint32_t mesh;             // 同 NodeMeshRef
+    uint32_t submesh;
+    float    world[12];        // 3x4 行主序, 平移已乘 G_SCALE_FACTOR
+};
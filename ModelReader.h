@@ -0,0 +1,460 @@
+/**********************************************************************************
+ * ModelReader.h
+ *
+ * .mesh / materials.bin / skeleton.bin / nodes.bin / instances.bin 运行时读取: 内存映射文件, 校验后直接以 span 访问各 section, 不做拷贝.
+ * 仅依赖 ModelFormat.h, MeshCodec.h 与系统头文件, 可单独拷入运行时工程.
+ *
+ **********************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "ModelFormat.h"
+#include "MeshCodec.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+template <typename T>
+struct Span {
+    const T* ptr = nullptr;
+    size_t   count = 0;
+
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+};
+
+// 只读内存映射, 不可拷贝
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept { swap(o); }
+    MappedFile& operator=(MappedFile&& o) noexcept { close(); swap(o); return *this; }
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+#if defined(_WIN32)
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) { close(); return false; }
+        size_ = (size_t)size.QuadPart;
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) { close(); return false; }
+        data_ = (const unsigned char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        if (!data_) { close(); return false; }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        data_ = (const unsigned char*)p;
+        size_ = (size_t)st.st_size;
+#endif
+        return true;
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap((void*)data_, size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void swap(MappedFile& o) {
+        std::swap(data_, o.data_);
+        std::swap(size_, o.size_);
+#if defined(_WIN32)
+        std::swap(file_, o.file_);
+        std::swap(mapping_, o.mapping_);
+#endif
+    }
+
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+};
+
+// 各 View 校验时共用的辅助函数
+namespace detail {
+
+inline bool fail(std::string* error, const std::string& msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+// [offset, offset + size) 是否落在 [0, total) 内, 不会溢出
+inline bool inRange(uint64_t offset, uint64_t size, uint64_t total) { return offset <= total && size <= total - offset; }
+
+} // namespace detail
+
+// 映射一个 .mesh 文件. open() 时一次性校验头部, 属性表与 section 表, 之后的访问不再检查.
+class MeshView {
+public:
+    bool open(const std::string& path, std::string* error = nullptr) {
+        header_ = nullptr;
+        if (!file_.open(path)) return detail::fail(error, "无法映射文件: " + path);
+        return validate(error);
+    }
+
+    const MeshFileHeader& header() const { return *header_; }
+
+    Span<VertexAttribute> attributes() const {
+        return { (const VertexAttribute*)(file_.data() + header_->attributeOffset), header_->attributeCount };
+    }
+
+    Span<MeshSection> sections() const {
+        return { (const MeshSection*)(file_.data() + header_->sectionOffset), header_->sectionCount };
+    }
+
+    // 第 nth 个指定类型的 section, 不存在返回 nullptr
+    const MeshSection* findSection(uint32_t type, uint32_t nth = 0) const {
+        for (const MeshSection& s : sections())
+            if (s.type == type && nth-- == 0) return &s;
+        return nullptr;
+    }
+
+    const VertexAttribute* findAttribute(uint16_t semantic) const {
+        for (const VertexAttribute& a : attributes())
+            if (a.semantic == semantic) return &a;
+        return nullptr;
+    }
+
+    // section 的原始字节 (编码后)
+    Span<unsigned char> bytes(const MeshSection& s) const { return { file_.data() + s.offset, s.size }; }
+
+    // 未编码 section 的类型化视图, stride 必须等于 sizeof(T)
+    template <typename T>
+    Span<T> view(const MeshSection& s) const {
+        if (s.encoding != ENCODING_RAW || s.stride != sizeof(T)) return {};
+        return { (const T*)(file_.data() + s.offset), s.elementCount };
+    }
+
+    template <typename T>
+    Span<T> view(uint32_t type, uint32_t nth = 0) const {
+        const MeshSection* s = findSection(type, nth);
+        return s ? view<T>(*s) : Span<T>{};
+    }
+
+    // 未压缩时的索引视图; 压缩过的索引返回空, 需用 decodeIndices()
+    Span<uint32_t> indices() const { return view<uint32_t>(SECTION_INDEX); }
+
+    // 把索引写入 out[header().indexCount], 未压缩时直接拷贝
+    bool decodeIndices(uint32_t* out) const {
+        const MeshSection* s = findSection(SECTION_INDEX);
+        if (!s) return header_->indexCount == 0;
+        if (s->encoding == ENCODING_RAW) { std::memcpy(out, file_.data() + s->offset, s->size); return true; }
+        if (s->encoding == ENCODING_INDEX_DELTA_VBYTE) return DecodeIndices(file_.data() + s->offset, s->size, out, s->elementCount);
+        return false;
+    }
+
+    // 把一个 VERTEX section 解码到 out[elementCount * stride], 未压缩时直接拷贝
+    bool decodeVertices(const MeshSection& s, void* out) const {
+        if (s.encoding == ENCODING_RAW) { std::memcpy(out, file_.data() + s.offset, s.size); return true; }
+        if (s.encoding == ENCODING_VERTEX_BYTEPLANE) return DecodeVertices(file_.data() + s.offset, s.size, (unsigned char*)out, s.elementCount, s.stride);
+        return false;
+    }
+
+    // 属性首个元素的地址, 第 i 个顶点位于 +i * attribute.stride; section 必须未编码, 否则先 decodeVertices()
+    const unsigned char* attributeData(const VertexAttribute& a) const {
+        const MeshSection& s = sections()[a.section];
+        return s.encoding == ENCODING_RAW ? file_.data() + s.offset + a.offset : nullptr;
+    }
+
+private:
+    bool validate(std::string* error) {
+        const uint64_t total = file_.size();
+        const unsigned char* base = file_.data();
+        if (total < sizeof(MeshFileHeader)) return detail::fail(error, "文件过小");
+        const MeshFileHeader* h = (const MeshFileHeader*)base;
+        if (h->magic != MESH_MAGIC) return detail::fail(error, "magic 不匹配");
+        if (h->version != MESH_VERSION) return detail::fail(error, "不支持的版本 " + std::to_string(h->version));
+        if (h->headerSize < sizeof(MeshFileHeader)) return detail::fail(error, "headerSize 无效");
+        if (h->attributeOffset % alignof(VertexAttribute) || h->sectionOffset % alignof(MeshSection)) return detail::fail(error, "表未对齐");
+        if (!detail::inRange(h->attributeOffset, (uint64_t)h->attributeCount * sizeof(VertexAttribute), total) ||
+            !detail::inRange(h->sectionOffset, (uint64_t)h->sectionCount * sizeof(MeshSection), total))
+            return detail::fail(error, "属性表 / section 表越界");
+        const MeshSection* secs = (const MeshSection*)(base + h->sectionOffset);
+        for (uint32_t i = 0; i < h->sectionCount; ++i) {
+            const MeshSection& s = secs[i];
+            if (s.offset % MESH_SECTION_ALIGNMENT) return detail::fail(error, "section " + std::to_string(i) + " 未对齐");
+            if (!detail::inRange(s.offset, s.size, total)) return detail::fail(error, "section " + std::to_string(i) + " 越界");
+            if (s.encoding == ENCODING_RAW && (uint64_t)s.elementCount * s.stride != s.size)
+                return detail::fail(error, "section " + std::to_string(i) + " 大小与 elementCount * stride 不符");
+        }
+        const VertexAttribute* attrs = (const VertexAttribute*)(base + h->attributeOffset);
+        for (uint32_t i = 0; i < h->attributeCount; ++i) {
+            const VertexAttribute& a = attrs[i];
+            if (a.section >= h->sectionCount || secs[a.section].type != SECTION_VERTEX) return detail::fail(error, "属性 " + std::to_string(i) + " 引用的 section 无效");
+            const MeshSection& s = secs[a.section];
+            if (s.elementCount != h->vertexCount || a.stride != s.stride || (uint64_t)a.offset + a.componentCount * 4u > a.stride)
+                return detail::fail(error, "属性 " + std::to_string(i) + " 超出顶点范围");
+        }
+        const MeshSection* idx = nullptr;
+        for (uint32_t i = 0; i < h->sectionCount && !idx; ++i) if (secs[i].type == SECTION_INDEX) idx = &secs[i];
+        if (idx && idx->elementCount != h->indexCount) return detail::fail(error, "索引数与头部不符");
+        // decodeIndices() 按 uint32 写入 indexCount 个元素, stride 不是 4 时原始拷贝会越过调用方缓冲
+        if (idx && idx->stride != sizeof(uint32_t)) return detail::fail(error, "索引 stride 不是 4");
+        header_ = h;
+        return true;
+    }
+
+    MappedFile file_;
+    const MeshFileHeader* header_ = nullptr;
+};
+
+// 映射 materials.bin. open() 时校验头部, 记录表与所有字符串引用, 之后按下标直接访问.
+class MaterialTableView {
+public:
+    bool open(const std::string& path, std::string* error = nullptr) {
+        header_ = nullptr;
+        if (!file_.open(path)) return detail::fail(error, "无法映射文件: " + path);
+        return validate(error);
+    }
+
+    Span<MaterialRecord> materials() const {
+        return { (const MaterialRecord*)(file_.data() + header_->recordOffset), header_->materialCount };
+    }
+
+    // 字符串池中的字符串, MATERIAL_NO_STRING 返回 nullptr
+    const char* string(uint32_t offset) const {
+        return offset == MATERIAL_NO_STRING ? nullptr : (const char*)file_.data() + header_->stringOffset + offset;
+    }
+
+    const char* texture(const MaterialRecord& m, uint32_t slot) const { return string(m.textures[slot]); }
+
+private:
+    bool validate(std::string* error) {
+        const uint64_t total = file_.size();
+        const unsigned char* base = file_.data();
+        if (total < sizeof(MaterialFileHeader)) return detail::fail(error, "文件过小");
+        const MaterialFileHeader* h = (const MaterialFileHeader*)base;
+        if (h->magic != MATERIAL_MAGIC) return detail::fail(error, "magic 不匹配");
+        if (h->version != MATERIAL_VERSION) return detail::fail(error, "不支持的版本 " + std::to_string(h->version));
+        if (h->headerSize < sizeof(MaterialFileHeader)) return detail::fail(error, "headerSize 无效");
+        if (h->recordOffset % alignof(MaterialRecord)) return detail::fail(error, "记录表未对齐");
+        if (!detail::inRange(h->recordOffset, (uint64_t)h->materialCount * sizeof(MaterialRecord), total) ||
+            !detail::inRange(h->stringOffset, h->stringSize, total))
+            return detail::fail(error, "记录表 / 字符串池越界");
+        if (h->stringSize && base[h->stringOffset + h->stringSize - 1] != '\0') return detail::fail(error, "字符串池未以 '\\0' 结尾");
+        const MaterialRecord* recs = (const MaterialRecord*)(base + h->recordOffset);
+        auto validString = [&](uint32_t s) { return s == MATERIAL_NO_STRING || s < h->stringSize; };
+        for (uint32_t i = 0; i < h->materialCount; ++i) {
+            bool ok = validString(recs[i].name);
+            for (uint32_t t = 0; t < MATERIAL_TEXTURE_SLOT_COUNT; ++t) ok = ok && validString(recs[i].textures[t]);
+            if (!ok) return detail::fail(error, "材质 " + std::to_string(i) + " 的字符串引用越界");
+        }
+        header_ = h;
+        return true;
+    }
+
+    MappedFile file_;
+    const MaterialFileHeader* header_ = nullptr;
+};
+
+// 映射 skeleton.bin. 矩阵以 SoA 存放: component(k)[i] 为第 i 根骨骼 3x4 矩阵的第 k 个分量 (k = row * 4 + col),
+// 每个分量数组按 SKELETON_SIMD_ALIGNMENT 对齐并补齐到 paddedCount, 可直接按 SKELETON_SIMD_WIDTH 根骨骼一组做 SIMD 运算.
+class SkeletonView {
+public:
+    bool open(const std::string& path, std::string* error = nullptr) {
+        header_ = nullptr;
+        if (!file_.open(path)) return detail::fail(error, "无法映射文件: " + path);
+        return validate(error);
+    }
+
+    uint32_t boneCount() const { return header_->boneCount; }
+    uint32_t paddedCount() const { return header_->paddedCount; }
+
+    Span<int32_t> parents() const { return { (const int32_t*)(file_.data() + header_->parentOffset), header_->boneCount }; }
+
+    const char* name(uint32_t bone) const {
+        return (const char*)file_.data() + header_->stringOffset + ((const uint32_t*)(file_.data() + header_->nameOffset))[bone];
+    }
+
+    const float* inverseBind(uint32_t k) const { return component(header_->inverseBindOffset, k); }
+    const float* bindLocal(uint32_t k) const { return component(header_->bindLocalOffset, k); }
+    const float* bindGlobal(uint32_t k) const { return component(header_->bindGlobalOffset, k); }
+
+    // 把 SoA 中第 bone 根骨骼的矩阵取成 3x4 行主序
+    static void gather(const float* const components[12], uint32_t bone, float out[12]) {
+        for (int k = 0; k < 12; ++k) out[k] = components[k][bone];
+    }
+
+    // 按名字查找骨骼, 不存在返回 -1
+    int findBone(const char* boneName) const {
+        if (header_->hashCapacity == 0) return -1;
+        const SkeletonNameSlot* slots = (const SkeletonNameSlot*)(file_.data() + header_->hashOffset);
+        const uint32_t mask = header_->hashCapacity - 1, h = HashBoneName(boneName);
+        for (uint32_t i = h & mask;; i = (i + 1) & mask) {
+            if (slots[i].bone == SKELETON_NO_BONE) return -1;
+            if (slots[i].hash == h && std::strcmp(name(slots[i].bone), boneName) == 0) return (int)slots[i].bone;
+        }
+    }
+
+private:
+    const float* component(uint32_t offset, uint32_t k) const {
+        return (const float*)(file_.data() + offset) + (size_t)k * header_->paddedCount;
+    }
+
+    bool validate(std::string* error) {
+        const uint64_t total = file_.size();
+        const unsigned char* base = file_.data();
+        if (total < sizeof(SkeletonFileHeader)) return detail::fail(error, "文件过小");
+        const SkeletonFileHeader* h = (const SkeletonFileHeader*)base;
+        if (h->magic != SKELETON_MAGIC) return detail::fail(error, "magic 不匹配");
+        if (h->version != SKELETON_VERSION) return detail::fail(error, "不支持的版本 " + std::to_string(h->version));
+        if (h->headerSize < sizeof(SkeletonFileHeader)) return detail::fail(error, "headerSize 无效");
+        if (h->paddedCount < h->boneCount || h->paddedCount % SKELETON_SIMD_WIDTH) return detail::fail(error, "paddedCount 无效");
+        if (h->boneCount && (h->hashCapacity <= h->boneCount || (h->hashCapacity & (h->hashCapacity - 1))))
+            return detail::fail(error, "哈希表容量无效");
+        const uint64_t matrixBytes = (uint64_t)h->paddedCount * 12 * sizeof(float);
+        for (uint32_t offset : { h->inverseBindOffset, h->bindLocalOffset, h->bindGlobalOffset }) {
+            if (offset % SKELETON_SIMD_ALIGNMENT) return detail::fail(error, "矩阵数组未对齐");
+            if (!detail::inRange(offset, matrixBytes, total)) return detail::fail(error, "矩阵数组越界");
+        }
+        if (h->parentOffset % alignof(int32_t) || h->nameOffset % alignof(uint32_t) || h->hashOffset % alignof(SkeletonNameSlot))
+            return detail::fail(error, "表未对齐");
+        if (!detail::inRange(h->parentOffset, (uint64_t)h->boneCount * sizeof(int32_t), total) ||
+            !detail::inRange(h->nameOffset, (uint64_t)h->boneCount * sizeof(uint32_t), total) ||
+            !detail::inRange(h->hashOffset, (uint64_t)h->hashCapacity * sizeof(SkeletonNameSlot), total) ||
+            !detail::inRange(h->stringOffset, h->stringSize, total))
+            return detail::fail(error, "表越界");
+        if (h->stringSize && base[h->stringOffset + h->stringSize - 1] != '\0') return detail::fail(error, "字符串池未以 '\\0' 结尾");
+        const int32_t* parents = (const int32_t*)(base + h->parentOffset);
+        const uint32_t* names = (const uint32_t*)(base + h->nameOffset);
+        for (uint32_t i = 0; i < h->boneCount; ++i) {
+            if (parents[i] < -1 || parents[i] >= (int32_t)i) return detail::fail(error, "骨骼 " + std::to_string(i) + " 的父骨骼未排在其前");
+            if (names[i] >= h->stringSize) return detail::fail(error, "骨骼 " + std::to_string(i) + " 的名字越界");
+        }
+        const SkeletonNameSlot* slots = (const SkeletonNameSlot*)(base + h->hashOffset);
+        uint32_t used = 0;
+        for (uint32_t i = 0; i < h->hashCapacity; ++i) {
+            if (slots[i].bone == SKELETON_NO_BONE) continue;
+            if (slots[i].bone >= h->boneCount || ++used > h->boneCount) return detail::fail(error, "哈希槽 " + std::to_string(i) + " 无效");
+        }
+        header_ = h;
+        return true;
+    }
+
+    MappedFile file_;
+    const SkeletonFileHeader* header_ = nullptr;
+};
+
+// 映射 nodes.bin. 节点按父节点在前排列, 按下标顺序遍历即可逐个累乘出世界变换.
+class NodeView {
+public:
+    bool open(const std::string& path, std::string* error = nullptr) {
+        header_ = nullptr;
+        if (!file_.open(path)) return detail::fail(error, "无法映射文件: " + path);
+        return validate(error);
+    }
+
+    Span<NodeRecord> nodes() const { return { (const NodeRecord*)(file_.data() + header_->nodeOffset), header_->nodeCount }; }
+
+    Span<NodeMeshRef> meshes(const NodeRecord& n) const {
+        return { (const NodeMeshRef*)(file_.data() + header_->meshRefOffset) + n.firstMesh, n.meshCount };
+    }
+
+    const char* name(const NodeRecord& n) const { return (const char*)file_.data() + header_->stringOffset + n.name; }
+
+private:
+    bool validate(std::string* error) {
+        const uint64_t total = file_.size();
+        const unsigned char* base = file_.data();
+        if (total < sizeof(NodeFileHeader)) return detail::fail(error, "文件过小");
+        const NodeFileHeader* h = (const NodeFileHeader*)base;
+        if (h->magic != NODE_MAGIC) return detail::fail(error, "magic 不匹配");
+        if (h->version != NODE_VERSION) return detail::fail(error, "不支持的版本 " + std::to_string(h->version));
+        if (h->headerSize < sizeof(NodeFileHeader)) return detail::fail(error, "headerSize 无效");
+        if (h->nodeOffset % alignof(NodeRecord) || h->meshRefOffset % alignof(NodeMeshRef)) return detail::fail(error, "表未对齐");
+        if (!detail::inRange(h->nodeOffset, (uint64_t)h->nodeCount * sizeof(NodeRecord), total) ||
+            !detail::inRange(h->meshRefOffset, (uint64_t)h->meshRefCount * sizeof(NodeMeshRef), total) ||
+            !detail::inRange(h->stringOffset, h->stringSize, total))
+            return detail::fail(error, "表越界");
+        if (h->stringSize && base[h->stringOffset + h->stringSize - 1] != '\0') return detail::fail(error, "字符串池未以 '\\0' 结尾");
+        const NodeRecord* nodes = (const NodeRecord*)(base + h->nodeOffset);
+        for (uint32_t i = 0; i < h->nodeCount; ++i) {
+            const NodeRecord& n = nodes[i];
+            if (n.parent < -1 || n.parent >= (int32_t)i) return detail::fail(error, "节点 " + std::to_string(i) + " 的父节点未排在其前");
+            if (n.name >= h->stringSize) return detail::fail(error, "节点 " + std::to_string(i) + " 的名字越界");
+            if (!detail::inRange(n.firstMesh, n.meshCount, h->meshRefCount)) return detail::fail(error, "节点 " + std::to_string(i) + " 的网格引用越界");
+        }
+        header_ = h;
+        return true;
+    }
+
+    MappedFile file_;
+    const NodeFileHeader* header_ = nullptr;
+};
+
+// 映射 instances.bin
+class InstanceView {
+public:
+    bool open(const std::string& path, std::string* error = nullptr) {
+        header_ = nullptr;
+        if (!file_.open(path)) return detail::fail(error, "无法映射文件: " + path);
+        return validate(error);
+    }
+
+    Span<MeshInstance> instances() const {
+        return { (const MeshInstance*)(file_.data() + header_->instanceOffset), header_->instanceCount };
+    }
+
+private:
+    bool validate(std::string* error) {
+        const uint64_t total = file_.size();
+        if (total < sizeof(InstanceFileHeader)) return detail::fail(error, "文件过小");
+        const InstanceFileHeader* h = (const InstanceFileHeader*)file_.data();
+        if (h->magic != INSTANCE_MAGIC) return detail::fail(error, "magic 不匹配");
+        if (h->version != INSTANCE_VERSION) return detail::fail(error, "不支持的版本 " + std::to_string(h->version));
+        if (h->headerSize < sizeof(InstanceFileHeader)) return detail::fail(error, "headerSize 无效");
+        if (h->instanceOffset % alignof(MeshInstance)) return detail::fail(error, "实例表未对齐");
+        if (!detail::inRange(h->instanceOffset, (uint64_t)h->instanceCount * sizeof(MeshInstance), total)) return detail::fail(error, "实例表越界");
+        header_ = h;
+        return true;
+    }
+
+    MappedFile file_;
+    const InstanceFileHeader* header_ = nullptr;
+};
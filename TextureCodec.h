@@ -0,0 +1,298 @@
+/**********************************************************************************
+ * TextureCodec.h
+ *
+ * 纹理处理: RGBA8 mip 链生成 (sRGB 在线性空间下采样) 与 BC1/BC3/BC4/BC5/BC7 块压缩.
+ * 每个块独立编码, 调用方按块行并行.
+ *
+ **********************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct Image {
+    uint32_t width = 0, height = 0;
+    std::vector<uint8_t> rgba;   // width * height * 4
+};
+
+// DXGI_FORMAT
+enum TextureFormat : uint32_t {
+    DXGI_R8G8B8A8_UNORM = 28,
+    DXGI_R8G8B8A8_UNORM_SRGB = 29,
+    DXGI_BC1_UNORM = 71,
+    DXGI_BC1_UNORM_SRGB = 72,
+    DXGI_BC3_UNORM = 77,
+    DXGI_BC3_UNORM_SRGB = 78,
+    DXGI_BC5_UNORM = 83,
+    DXGI_BC7_UNORM = 98,
+    DXGI_BC7_UNORM_SRGB = 99,
+};
+
+// ---- mip ----
+
+inline float SrgbToLinear(float c) { return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f); }
+inline float LinearToSrgb(float c) { return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f; }
+
+// 2x2 盒式滤波 (奇数边长时最后一行/列与自身平均). srgb 时 RGB 先转线性再平均, alpha 始终线性.
+// normalMap 时 RG(B) 按 [-1, 1] 向量平均后重新归一化.
+inline Image DownsampleImage(const Image& src, bool srgb, bool normalMap) {
+    static const std::vector<float> toLinear = [] {
+        std::vector<float> t(256);
+        for (int i = 0; i < 256; ++i) t[i] = SrgbToLinear(i / 255.0f);
+        return t;
+    }();
+    Image dst;
+    dst.width = std::max(1u, src.width / 2);
+    dst.height = std::max(1u, src.height / 2);
+    dst.rgba.resize((size_t)dst.width * dst.height * 4);
+    for (uint32_t y = 0; y < dst.height; ++y) {
+        uint32_t y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+        for (uint32_t x = 0; x < dst.width; ++x) {
+            uint32_t x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+            const uint8_t* p[4] = { &src.rgba[((size_t)y0 * src.width + x0) * 4], &src.rgba[((size_t)y0 * src.width + x1) * 4],
+                                    &src.rgba[((size_t)y1 * src.width + x0) * 4], &src.rgba[((size_t)y1 * src.width + x1) * 4] };
+            uint8_t* o = &dst.rgba[((size_t)y * dst.width + x) * 4];
+            float sum[4] = {};
+            for (int k = 0; k < 4; ++k)
+                for (int c = 0; c < 4; ++c) sum[c] += (srgb && c < 3) ? toLinear[p[k][c]] : normalMap && c < 3 ? p[k][c] / 127.5f - 1.0f : p[k][c] / 255.0f;
+            for (int c = 0; c < 4; ++c) sum[c] *= 0.25f;
+            if (normalMap) {
+                float len = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                for (int c = 0; c < 3; ++c) sum[c] = len > 1e-6f ? (sum[c] / len) * 0.5f + 0.5f : 0.5f;
+            }
+            for (int c = 0; c < 4; ++c) {
+                float v = (srgb && c < 3) ? LinearToSrgb(sum[c]) : sum[c];
+                o[c] = (uint8_t)std::lround(std::min(std::max(v, 0.0f), 1.0f) * 255.0f);
+            }
+        }
+    }
+    return dst;
+}
+
+inline std::vector<Image> BuildMipChain(Image base, bool srgb, bool normalMap) {
+    std::vector<Image> mips;
+    mips.push_back(std::move(base));
+    while (mips.back().width > 1 || mips.back().height > 1) mips.push_back(DownsampleImage(mips.back(), srgb, normalMap));
+    return mips;
+}
+
+// 取 (bx, by) 处的 4x4 块, 越界按边缘像素补齐
+inline void FetchBlock(const Image& img, uint32_t bx, uint32_t by, uint8_t block[64]) {
+    for (uint32_t y = 0; y < 4; ++y) {
+        uint32_t sy = std::min(by * 4 + y, img.height - 1);
+        for (uint32_t x = 0; x < 4; ++x) {
+            uint32_t sx = std::min(bx * 4 + x, img.width - 1);
+            std::memcpy(block + (y * 4 + x) * 4, &img.rgba[((size_t)sy * img.width + sx) * 4], 4);
+        }
+    }
+}
+
+// ---- 共用: 主轴端点 ----
+
+// 沿协方差主轴 (幂迭代) 取投影最小/最大的两个点作为端点, channels = 3 (RGB) 或 4 (RGBA)
+inline void PrincipalEndpoints(const uint8_t block[64], int channels, float lo[4], float hi[4]) {
+    float mean[4] = {};
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < channels; ++c) mean[c] += block[i * 4 + c];
+    for (int c = 0; c < channels; ++c) mean[c] /= 16.0f;
+    float cov[4][4] = {};
+    for (int i = 0; i < 16; ++i) {
+        float d[4];
+        for (int c = 0; c < channels; ++c) d[c] = block[i * 4 + c] - mean[c];
+        for (int a = 0; a < channels; ++a)
+            for (int b = 0; b < channels; ++b) cov[a][b] += d[a] * d[b];
+    }
+    float axis[4] = { 1.0f, 1.0f, 1.0f, channels == 4 ? 1.0f : 0.0f };
+    for (int it = 0; it < 8; ++it) {
+        float next[4] = {};
+        for (int a = 0; a < channels; ++a)
+            for (int b = 0; b < channels; ++b) next[a] += cov[a][b] * axis[b];
+        float len = 0.0f;
+        for (int c = 0; c < channels; ++c) len += next[c] * next[c];
+        if (len < 1e-12f) break;
+        len = 1.0f / std::sqrt(len);
+        for (int c = 0; c < channels; ++c) axis[c] = next[c] * len;
+    }
+    float tmin = 1e30f, tmax = -1e30f;
+    for (int i = 0; i < 16; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < channels; ++c) t += (block[i * 4 + c] - mean[c]) * axis[c];
+        tmin = std::min(tmin, t);
+        tmax = std::max(tmax, t);
+    }
+    for (int c = 0; c < 4; ++c) {
+        lo[c] = c < channels ? std::min(std::max(mean[c] + axis[c] * tmin, 0.0f), 255.0f) : 255.0f;
+        hi[c] = c < channels ? std::min(std::max(mean[c] + axis[c] * tmax, 0.0f), 255.0f) : 255.0f;
+    }
+}
+
+// ---- BC1 ----
+
+inline uint16_t PackRGB565(const float c[3]) {
+    int r = (int)std::lround(c[0] * 31.0f / 255.0f), g = (int)std::lround(c[1] * 63.0f / 255.0f), b = (int)std::lround(c[2] * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void UnpackRGB565(uint16_t v, int out[3]) {
+    int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+// 4 色模式 (color0 > color1); 不使用 1-bit alpha
+inline void EncodeBC1Block(const uint8_t block[64], uint8_t out[8]) {
+    float lo[4], hi[4];
+    PrincipalEndpoints(block, 3, lo, hi);
+    uint16_t c0 = PackRGB565(hi), c1 = PackRGB565(lo);
+    if (c0 < c1) std::swap(c0, c1);
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        int e0[3], e1[3], pal[4][3];
+        UnpackRGB565(c0, e0);
+        UnpackRGB565(c1, e1);
+        for (int c = 0; c < 3; ++c) {
+            pal[0][c] = e0[c];
+            pal[1][c] = e1[c];
+            pal[2][c] = (2 * e0[c] + e1[c]) / 3;
+            pal[3][c] = (e0[c] + 2 * e1[c]) / 3;
+        }
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestErr = 1 << 30;
+            for (int k = 0; k < 4; ++k) {
+                int err = 0;
+                for (int c = 0; c < 3; ++c) { int d = block[i * 4 + c] - pal[k][c]; err += d * d; }
+                if (err < bestErr) { bestErr = err; best = k; }
+            }
+            indices |= (uint32_t)best << (i * 2);
+        }
+    }
+    std::memcpy(out, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+// ---- BC4 (单通道, BC3 alpha 与 BC5 的组成部分) ----
+
+inline void EncodeBC4Block(const uint8_t values[16], uint8_t out[8]) {
+    uint8_t a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; ++i) { a0 = std::max(a0, values[i]); a1 = std::min(a1, values[i]); }
+    out[0] = a0;
+    out[1] = a1;
+    uint64_t bits = 0;
+    if (a0 != a1) {
+        // 8 值模式: 调色板下标 0 = a0, 1 = a1, 2..7 = 插值; 按到 a1 的比例取最近档位再映射
+        for (int i = 0; i < 16; ++i) {
+            int t = (int)std::lround((values[i] - a1) * 7.0f / (a0 - a1));   // 0 = a1, 7 = a0
+            int idx = t == 7 ? 0 : t == 0 ? 1 : 8 - t;
+            bits |= (uint64_t)idx << (i * 3);
+        }
+    }
+    for (int b = 0; b < 6; ++b) out[2 + b] = (uint8_t)(bits >> (b * 8));
+}
+
+inline void EncodeBC3Block(const uint8_t block[64], uint8_t out[16]) {
+    uint8_t alpha[16];
+    for (int i = 0; i < 16; ++i) alpha[i] = block[i * 4 + 3];
+    EncodeBC4Block(alpha, out);
+    EncodeBC1Block(block, out + 8);
+}
+
+// 法线贴图: R, G 两个 BC4 通道, 运行时重建 Z
+inline void EncodeBC5Block(const uint8_t block[64], uint8_t out[16]) {
+    uint8_t r[16], g[16];
+    for (int i = 0; i < 16; ++i) { r[i] = block[i * 4]; g[i] = block[i * 4 + 1]; }
+    EncodeBC4Block(r, out);
+    EncodeBC4Block(g, out + 8);
+}
+
+// ---- BC7 (仅 mode 6: 单分区, RGBA 7 位端点 + 各自 p-bit, 4 位下标) ----
+
+inline void EncodeBC7Block(const uint8_t block[64], uint8_t out[16]) {
+    static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    float lo[4], hi[4];
+    PrincipalEndpoints(block, 4, lo, hi);
+    // 每个端点在 p-bit = 0/1 中选量化误差较小的一个
+    int q[2][4], p[2], e[2][4];
+    const float* ends[2] = { lo, hi };
+    for (int k = 0; k < 2; ++k) {
+        int bestErr = 1 << 30;
+        for (int pb = 0; pb < 2; ++pb) {
+            int qq[4], err = 0;
+            for (int c = 0; c < 4; ++c) {
+                qq[c] = std::min(127, std::max(0, (int)std::lround((ends[k][c] - pb) / 2.0f)));
+                int d = ((qq[c] << 1) | pb) - (int)std::lround(ends[k][c]);
+                err += d * d;
+            }
+            if (err < bestErr) { bestErr = err; p[k] = pb; std::copy(qq, qq + 4, q[k]); }
+        }
+        for (int c = 0; c < 4; ++c) e[k][c] = (q[k][c] << 1) | p[k];
+    }
+    int idx[16];
+    for (int i = 0; i < 16; ++i) {
+        int best = 0, bestErr = 1 << 30;
+        for (int w = 0; w < 16; ++w) {
+            int err = 0;
+            for (int c = 0; c < 4; ++c) {
+                int v = (e[0][c] * (64 - weights[w]) + e[1][c] * weights[w] + 32) >> 6;
+                int d = block[i * 4 + c] - v;
+                err += d * d;
+            }
+            if (err < bestErr) { bestErr = err; best = w; }
+        }
+        idx[i] = best;
+    }
+    // 锚点 (像素 0) 的下标最高位必须为 0, 否则交换端点并反转下标
+    if (idx[0] & 8) {
+        std::swap(q[0], q[1]);
+        std::swap(p[0], p[1]);
+        for (int i = 0; i < 16; ++i) idx[i] = 15 - idx[i];
+    }
+    uint64_t lo64 = 0, hi64 = 0;
+    int pos = 0;
+    auto put = [&](uint64_t v, int bits) {
+        for (int b = 0; b < bits; ++b, ++pos) {
+            uint64_t bit = (v >> b) & 1;
+            if (pos < 64) lo64 |= bit << pos;
+            else hi64 |= bit << (pos - 64);
+        }
+    };
+    put(1u << 6, 7);   // mode 6
+    for (int c = 0; c < 4; ++c) { put((uint64_t)q[0][c], 7); put((uint64_t)q[1][c], 7); }
+    put((uint64_t)p[0], 1);
+    put((uint64_t)p[1], 1);
+    put((uint64_t)idx[0], 3);
+    for (int i = 1; i < 16; ++i) put((uint64_t)idx[i], 4);
+    std::memcpy(out, &lo64, 8);
+    std::memcpy(out + 8, &hi64, 8);
+}
+
+inline bool IsBlockCompressed(uint32_t dxgiFormat) {
+    return dxgiFormat != DXGI_R8G8B8A8_UNORM && dxgiFormat != DXGI_R8G8B8A8_UNORM_SRGB;
+}
+
+inline uint32_t BlockBytes(uint32_t dxgiFormat) {
+    switch (dxgiFormat) {
+    case DXGI_BC1_UNORM: case DXGI_BC1_UNORM_SRGB: return 8;
+    default: return 16;
+    }
+}
+
+// 压缩一级 mip 中第 by 行的全部块, out 指向该行的起始位置
+inline void EncodeBlockRow(const Image& img, uint32_t dxgiFormat, uint32_t by, uint8_t* out) {
+    uint32_t blocksX = (img.width + 3) / 4, bytes = BlockBytes(dxgiFormat);
+    uint8_t block[64];
+    for (uint32_t bx = 0; bx < blocksX; ++bx, out += bytes) {
+        FetchBlock(img, bx, by, block);
+        switch (dxgiFormat) {
+        case DXGI_BC1_UNORM: case DXGI_BC1_UNORM_SRGB: EncodeBC1Block(block, out); break;
+        case DXGI_BC3_UNORM: case DXGI_BC3_UNORM_SRGB: EncodeBC3Block(block, out); break;
+        case DXGI_BC5_UNORM: EncodeBC5Block(block, out); break;
+        default: EncodeBC7Block(block, out); break;
+        }
+    }
+}
@@ -12,10 +12,32 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <array>
+#include <set>
 #include <unordered_map>
 #include <filesystem>
 #include <algorithm>
 #include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+
+#if defined(MC_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(MC_HAVE_LZ4)
+#include <lz4frame.h>
+#endif
+
+#if defined(MC_HAVE_STB)
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#endif
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -25,22 +47,101 @@
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+#include "ModelFormat.h"
+#include "MeshCodec.h"
+#include "TextureCodec.h"
+#include "ModelReader.h"
+
 // 模型缩放
 const float G_SCALE_FACTOR = 0.01f;
 
-struct Vertex {
+// 命令行选项
+struct ConvertOptions {
+    double      sampleRate = 30.0;       // --sample-rate <fps>   逐帧采样频率
+    std::string rootMotionBone;          // --root-motion <bone>  提取根运动的骨骼, 为空则不提取
+    bool        rootMotionInPlace = true;// --root-motion-mode inplace|zero
+    bool        additiveAll = false;     // --additive all
+    std::set<unsigned> additiveClips;    // --additive <i,j,...>  输出为叠加动画的片段
+    int         additiveRefClip = -1;    // --additive-ref bind|<clip>:<frame>  -1 表示绑定姿态
+    double      additiveRefFrame = 0.0;
+    std::string clipManifest;            // --clips <manifest.json>  按帧范围把源动画切成多个片段
+    bool        bakeSkinning = false;    // --bake-skinning  按 sampleRate 烘焙每帧蒙皮矩阵纹理
+    int         bakeVertexMesh = -1;     // --bake-vertices <mesh>  同时烘焙该网格的逐顶点位置纹理
+    bool        benchmark = false;       // --benchmark  输出编解码内核与加载路径的耗时对比
+    int         maxInfluences = 4;       // --max-influences 2|4|8  每顶点骨骼影响数
+    unsigned    bonePalette = 0;         // --bone-palette <N>  按每批最多 N 根骨骼切分蒙皮网格, 0 为不切分
+    bool        splitStreams = false;    // --split-streams  顶点拆成 位置 / 着色属性 / 蒙皮 三个独立流
+    bool        dedup = false;           // --dedup  按最终顶点字节去重并重映射索引
+    bool        mergeByMaterial = false; // --merge-by-material  合并同材质的静态网格
+    bool        bakeTransforms = false;  // --bake-transforms  静态网格烘焙节点世界变换, 多次引用的网格输出实例列表
+    bool        instanceGeometry = false;// --instance-geometry  几何完全相同的静态网格只输出一份, 其余改为实例
+    bool        compressIndices = false; // --compress-indices  索引以 zigzag 差分 + Stream VByte 存储
+    bool        compressVertices = false;// --compress-vertices  顶点 section 以字节平面差分编码存储
+    std::string compressCodec = "none";  // --compress zstd|lz4[:level]  输出文件整体压缩
+    std::string textureFormat;           // --textures bc1|bc3|bc7  解码 + mip + 块压缩为 DDS, 为空则原样拷贝
+    int         compressLevel = 0;
+};
+static ConvertOptions g_options;
+
+// 每顶点 N 个骨骼影响的顶点布局 (N = 2/4/8), 在编译期特化, 内循环不做运行时分支
+template <int N>
+struct VertexT {
     float position[3]{};
     float texcoord[2]{};
     float normal[3]{};
     float tangent[3]{};
-    int   boneIDs[4]{ -1,-1,-1,-1 };
-    float weights[4]{ 0,0,0,0 };
+    int   boneIDs[N];
+    float weights[N]{};
+    VertexT() { std::fill(boneIDs, boneIDs + N, -1); }
 };
 
-struct MeshHeader {
-    uint32_t vertexCount{};
-    uint32_t indexCount{};
-    uint32_t materialIndex{};
+const int MAX_BONE_INFLUENCES = 8;
+
+struct ClipChannel {
+    std::string bone;
+    std::vector<aiVectorKey> posKeys;
+    std::vector<aiQuatKey>   rotKeys;
+    std::vector<aiVectorKey> scaleKeys;
+};
+
+struct AnimClip {
+    std::string name;
+    double duration{};
+    double ticksPerSecond{};
+    bool loop = false;
+    std::vector<ClipChannel> channels;
+};
+
+// 片段清单中的一项: 源动画 source 的 [start, end] 帧 (按 fps, 默认等于源动画 ticksPerSecond)
+struct ClipRange {
+    std::string name;
+    unsigned source{};
+    double start{};
+    double end{};
+    double fps{};
+    bool loop = false;
+};
+
+struct BonePose {
+    aiVector3D   t;
+    aiQuaternion r;
+    aiVector3D   s{ 1.0f, 1.0f, 1.0f };
+};
+
+// 骨骼之上的场景节点 (Armature / 不带权重的骨骼等) 及其静止局部变换, 已乘 G_SCALE_FACTOR
+struct AncestorNode {
+    std::string name;
+    aiMatrix4x4 local;
+};
+
+struct SkeletonBone {
+    std::string name;
+    int parentId{};
+    aiMatrix4x4 offset;     // inverse bind, 已乘 G_SCALE_FACTOR
+    aiMatrix4x4 bindLocal;  // 相对父骨骼的绑定姿态, 已乘 G_SCALE_FACTOR; 根骨骼为网格空间绑定姿态 (= offset 的逆)
+    aiMatrix4x4 ancestors;  // 仅根骨骼: 父节点空间 -> 网格空间 (= meshInverse * 非骨骼祖先节点的累积变换), 动画关键帧的局部变换需左乘它, 已乘 G_SCALE_FACTOR
+    aiMatrix4x4 meshInverse;  // 仅根骨骼: 提供 offset 的蒙皮网格所在节点世界变换的逆 (offset = inverse(boneWorld) * meshWorld)
+    std::vector<AncestorNode> ancestorNodes;  // 仅根骨骼: 同一条祖先链, 自场景根向下; 烘焙时逐节点采样其动画通道
 };
 
 struct TempBoneInfo {
@@ -48,52 +149,1210 @@ struct TempBoneInfo {
     unsigned int originalIndex;
     int parentIndex;
     aiMatrix4x4 offsetMatrix;
+    unsigned mesh;            // offsetMatrix 取自的网格
 };
 
-static inline void AddBoneWeight(Vertex& v, int boneId, float w) {
-    for (int i = 0; i < 4; ++i) if (v.boneIDs[i] < 0) { v.boneIDs[i] = boneId; v.weights[i] = w; return; }
-    int minIdx = 0; for (int i = 1; i < 4; ++i) if (v.weights[i] < v.weights[minIdx]) minIdx = i;
-    if (w > v.weights[minIdx]) { v.boneIDs[minIdx] = boneId; v.weights[minIdx] = w; }
-}
+static void logln(const std::string& s) { std::cout << s << std::endl; }
 
-static inline void NormalizeWeights(Vertex& v) {
-    float s = v.weights[0] + v.weights[1] + v.weights[2] + v.weights[3];
+template <typename V>
+static inline void NormalizeWeights(V& v) {
+    float s = 0.0f;
+    for (float w : v.weights) s += w;
     if (s > 1e-6f) { float inv = 1.0f / s; for (float& x : v.weights) x *= inv; }
 }
 
-static inline json MatrixToJson(const aiMatrix4x4& m) {
-    return json::array({ m.a1, m.b1, m.c1, m.d1,
-                         m.a2, m.b2, m.c2, m.d2,
-                         m.a3, m.b3, m.c3, m.d3,
-                         m.a4, m.b4, m.c4, m.d4 });
+struct BoneInfluence {
+    int   boneId;
+    float weight;
+};
+
+struct WeightStats {
+    unsigned truncatedVertices = 0;  // 影响数超过 K 而被截断的顶点数
+    float    maxLostWeight = 0.0f;   // 单个顶点丢失的最大权重占比 (归一化前)
+};
+
+// 骨骼权重分配: 先把所有影响按顶点连续收集 (计数 -> 前缀和 -> 填充), 再对每个顶点
+// 按 (权重降序, 骨骼 ID 升序) 确定性地保留前 K 个; K 由顶点类型的 boneIDs 长度决定.
+template <typename V>
+static WeightStats AssignBoneWeights(std::vector<V>& vertices, const aiMesh* mesh, const std::map<std::string, unsigned>& finalBoneMap) {
+    constexpr size_t K = std::extent<decltype(V::boneIDs)>::value;
+    WeightStats stats;
+    if (mesh->mNumBones == 0) return stats;
+    std::vector<int> boneIds(mesh->mNumBones, -1);
+    for (unsigned bi = 0; bi < mesh->mNumBones; ++bi) {
+        auto it = finalBoneMap.find(mesh->mBones[bi]->mName.C_Str());
+        if (it != finalBoneMap.end()) boneIds[bi] = (int)it->second;
+    }
+    std::vector<uint32_t> offsets(vertices.size() + 1, 0);
+    for (unsigned bi = 0; bi < mesh->mNumBones; ++bi) {
+        if (boneIds[bi] < 0) continue;
+        const aiBone* b = mesh->mBones[bi];
+        for (unsigned wi = 0; wi < b->mNumWeights; ++wi)
+            if (b->mWeights[wi].mWeight > 0.0f && b->mWeights[wi].mVertexId < vertices.size()) ++offsets[b->mWeights[wi].mVertexId + 1];
+    }
+    for (size_t v = 0; v < vertices.size(); ++v) offsets[v + 1] += offsets[v];
+    std::vector<BoneInfluence> influences(offsets.back());
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (unsigned bi = 0; bi < mesh->mNumBones; ++bi) {
+        if (boneIds[bi] < 0) continue;
+        const aiBone* b = mesh->mBones[bi];
+        for (unsigned wi = 0; wi < b->mNumWeights; ++wi) {
+            const aiVertexWeight& w = b->mWeights[wi];
+            if (w.mWeight > 0.0f && w.mVertexId < vertices.size()) influences[cursor[w.mVertexId]++] = { boneIds[bi], w.mWeight };
+        }
+    }
+    auto heavier = [](const BoneInfluence& a, const BoneInfluence& b) { return a.weight != b.weight ? a.weight > b.weight : a.boneId < b.boneId; };
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        BoneInfluence* first = influences.data() + offsets[v];
+        BoneInfluence* last = influences.data() + offsets[v + 1];
+        size_t n = (size_t)(last - first);
+        size_t keep = std::min(n, K);
+        std::partial_sort(first, first + keep, last, heavier);
+        if (n > K) {
+            float total = 0.0f, lost = 0.0f;
+            for (BoneInfluence* it = first; it != last; ++it) { total += it->weight; if (it >= first + K) lost += it->weight; }
+            ++stats.truncatedVertices;
+            if (total > 0.0f) stats.maxLostWeight = std::max(stats.maxLostWeight, lost / total);
+        }
+        V& out = vertices[v];
+        for (size_t k = 0; k < keep; ++k) { out.boneIDs[k] = first[k].boneId; out.weights[k] = first[k].weight; }
+        NormalizeWeights(out);
+    }
+    return stats;
 }
 
 static void BuildNodeMap(const aiNode* n, std::unordered_map<std::string, const aiNode*>& map) {
     if (!n) return; map[n->mName.C_Str()] = n; for (unsigned i = 0; i < n->mNumChildren; ++i) BuildNodeMap(n->mChildren[i], map);
 }
 
-static bool FindBoneOffset(const aiScene* s, const std::string& name, aiMatrix4x4& out) {
+// 节点树按前序展开 (父节点总在子节点之前), 平移已乘 G_SCALE_FACTOR
+struct FlatNode {
+    const aiNode* node;
+    int parent;
+    aiMatrix4x4 local;
+    aiMatrix4x4 world;
+};
+
+static void FlattenNodes(const aiNode* n, int parent, std::vector<FlatNode>& out) {
+    if (!n) return;
+    aiMatrix4x4 local = n->mTransformation;
+    local.a4 *= G_SCALE_FACTOR;
+    local.b4 *= G_SCALE_FACTOR;
+    local.c4 *= G_SCALE_FACTOR;
+    aiMatrix4x4 world = parent < 0 ? local : out[parent].world * local;
+    out.push_back({ n, parent, local, world });
+    int self = (int)out.size() - 1;
+    for (unsigned i = 0; i < n->mNumChildren; ++i) FlattenNodes(n->mChildren[i], self, out);
+}
+
+static bool FindBoneOffset(const aiScene* s, const std::string& name, aiMatrix4x4& out, unsigned* meshIndex = nullptr) {
     for (unsigned m = 0; m < s->mNumMeshes; ++m) {
         const aiMesh* mesh = s->mMeshes[m];
         for (unsigned bi = 0; bi < mesh->mNumBones; ++bi) {
             const aiBone* b = mesh->mBones[bi];
-            if (name == b->mName.C_Str()) { out = b->mOffsetMatrix; return true; }
+            if (name == b->mName.C_Str()) { out = b->mOffsetMatrix; if (meshIndex) *meshIndex = m; return true; }
+        }
+    }
+    return false;
+}
+
+static aiVector3D SampleVectorKeys(const std::vector<aiVectorKey>& keys, double t) {
+    if (keys.empty()) return aiVector3D();
+    auto it = std::upper_bound(keys.begin(), keys.end(), t, [](double v, const aiVectorKey& k) { return v < k.mTime; });
+    if (it == keys.begin()) return keys.front().mValue;
+    if (it == keys.end()) return keys.back().mValue;
+    const aiVectorKey& a = *(it - 1); const aiVectorKey& b = *it;
+    float f = (float)((t - a.mTime) / (b.mTime - a.mTime));
+    return a.mValue + (b.mValue - a.mValue) * f;
+}
+
+static aiQuaternion SampleQuatKeys(const std::vector<aiQuatKey>& keys, double t) {
+    if (keys.empty()) return aiQuaternion();
+    auto it = std::upper_bound(keys.begin(), keys.end(), t, [](double v, const aiQuatKey& k) { return v < k.mTime; });
+    if (it == keys.begin()) return keys.front().mValue;
+    if (it == keys.end()) return keys.back().mValue;
+    const aiQuatKey& a = *(it - 1); const aiQuatKey& b = *it;
+    aiQuaternion out; aiQuaternion::Interpolate(out, a.mValue, b.mValue, (float)((t - a.mTime) / (b.mTime - a.mTime)));
+    return out.Normalize();
+}
+
+// q 相对 ref 绕 Y 轴(上方向)转过的角度: q * conj(ref) 按 swing-twist 分解后绕 Y 的 twist, 不依赖骨骼自身哪个轴朝前
+static inline float RelativeYaw(const aiQuaternion& q, const aiQuaternion& ref) {
+    aiQuaternion inv = ref;
+    inv.Conjugate();
+    aiQuaternion d = q * inv;
+    return 2.0f * std::atan2(d.y, d.w);
+}
+
+static inline aiQuaternion YawQuat(float yaw) { return aiQuaternion(aiVector3D(0, 1, 0), yaw); }
+
+static AnimClip LoadClip(unsigned idx, const aiAnimation* anim) {
+    AnimClip clip;
+    clip.name = anim->mName.C_Str();
+    if (clip.name.empty()) clip.name = "anim_" + std::to_string(idx);
+    clip.duration = anim->mDuration;
+    clip.ticksPerSecond = (anim->mTicksPerSecond > 0.0 ? anim->mTicksPerSecond : 30.0);
+    for (unsigned c = 0; c < anim->mNumChannels; ++c) {
+        const aiNodeAnim* ch = anim->mChannels[c];
+        ClipChannel cc;
+        cc.bone = ch->mNodeName.C_Str();
+        cc.posKeys.assign(ch->mPositionKeys, ch->mPositionKeys + ch->mNumPositionKeys);
+        cc.rotKeys.assign(ch->mRotationKeys, ch->mRotationKeys + ch->mNumRotationKeys);
+        cc.scaleKeys.assign(ch->mScalingKeys, ch->mScalingKeys + ch->mNumScalingKeys);
+        clip.channels.push_back(std::move(cc));
+    }
+    return clip;
+}
+
+// 节点的父节点链在静止姿态下的累积变换 (节点关键帧所在空间 -> 模型空间), 找不到节点时为单位矩阵
+static aiMatrix4x4 RestParentTransform(const aiScene* scene, const std::string& name) {
+    std::unordered_map<std::string, const aiNode*> nodeMap;
+    BuildNodeMap(scene->mRootNode, nodeMap);
+    aiMatrix4x4 m;
+    auto it = nodeMap.find(name);
+    for (const aiNode* p = it != nodeMap.end() ? it->second->mParent : nullptr; p; p = p->mParent) m = p->mTransformation * m;
+    return m;
+}
+
+// 根运动提取: 按 sampleRate 逐帧采样根骨骼, 输出每帧的位移增量(在上一帧朝向空间内, 朝向以首帧为 0)与 yaw 增量,
+// 然后把根通道改为原地(保留高度, 去掉水平位移与 yaw 变化)或归零(去掉全部位移与 yaw 变化).
+// 关键帧在父节点空间 (如 Blender 导出的 Z-up Armature), 先用 parent 的旋转/缩放换到模型空间 (Y 向上) 再取水平面与 yaw,
+// 原地化后的关键帧再换回父节点空间.
+static json ExtractRootMotion(AnimClip& clip, const std::string& boneName, bool inPlace, double fps, const aiMatrix4x4& parent) {
+    auto it = std::find_if(clip.channels.begin(), clip.channels.end(), [&](const ClipChannel& c) { return c.bone == boneName; });
+    if (it == clip.channels.end()) return json();
+    ClipChannel& root = *it;
+    aiMatrix4x4 linear = parent;
+    linear.a4 = linear.b4 = linear.c4 = 0.0f;
+    const aiMatrix4x4 inverse = aiMatrix4x4(linear).Inverse();
+    aiVector3D parentScale, parentPos;
+    aiQuaternion parentRot;
+    parent.Decompose(parentScale, parentRot, parentPos);
+    aiQuaternion parentRotInv = parentRot;
+    parentRotInv.Conjugate();
+    unsigned frameCount = (unsigned)std::floor(clip.duration / clip.ticksPerSecond * fps + 1e-6) + 1;
+    std::vector<float> deltas;
+    deltas.reserve(frameCount * 4);
+    const aiQuaternion startRot = parentRot * SampleQuatKeys(root.rotKeys, 0.0);
+    aiVector3D prevPos = linear * SampleVectorKeys(root.posKeys, 0.0);
+    float prevYaw = 0.0f;
+    for (unsigned f = 0; f < frameCount; ++f) {
+        double t = std::min(f / fps * clip.ticksPerSecond, clip.duration);
+        aiVector3D pos = linear * SampleVectorKeys(root.posKeys, t);
+        float yaw = RelativeYaw(parentRot * SampleQuatKeys(root.rotKeys, t), startRot);
+        float dYaw = yaw - prevYaw;
+        while (dYaw > (float)AI_MATH_PI) dYaw -= 2.0f * (float)AI_MATH_PI;
+        while (dYaw < -(float)AI_MATH_PI) dYaw += 2.0f * (float)AI_MATH_PI;
+        aiVector3D d = pos - prevPos;
+        if (inPlace) d.y = 0.0f;
+        float c = std::cos(prevYaw), s = std::sin(prevYaw);
+        deltas.push_back((d.x * c - d.z * s) * G_SCALE_FACTOR);
+        deltas.push_back(d.y * G_SCALE_FACTOR);
+        deltas.push_back((d.x * s + d.z * c) * G_SCALE_FACTOR);
+        deltas.push_back(dYaw);
+        prevPos = pos; prevYaw = yaw;
+    }
+    aiVector3D startPos = linear * SampleVectorKeys(root.posKeys, 0.0);
+    for (auto& k : root.posKeys) {
+        if (inPlace) { aiVector3D m = linear * k.mValue; m.x = startPos.x; m.z = startPos.z; k.mValue = inverse * m; }
+        else k.mValue = aiVector3D();
+    }
+    for (auto& k : root.rotKeys) {
+        aiQuaternion m = parentRot * k.mValue;
+        k.mValue = (parentRotInv * (YawQuat(-RelativeYaw(m, startRot)) * m)).Normalize();
+    }
+    json j;
+    j["bone"] = boneName;
+    j["mode"] = inPlace ? "inplace" : "zero";
+    j["frameRate"] = fps;
+    j["frameCount"] = frameCount;
+    j["deltas"] = deltas;
+    return j;
+}
+
+template <typename Key, typename Sampler>
+static std::vector<Key> SliceKeys(const std::vector<Key>& keys, double t0, double t1, Sampler sample) {
+    std::vector<Key> out;
+    if (keys.empty()) return out;
+    out.push_back(Key(0.0, sample(keys, t0)));
+    for (const auto& k : keys) if (k.mTime > t0 && k.mTime < t1) out.push_back(Key(k.mTime - t0, k.mValue));
+    if (t1 > t0) out.push_back(Key(t1 - t0, sample(keys, t1)));
+    return out;
+}
+
+// 截取 [t0, t1] (tick) 区间, 区间端点插值出边界关键帧, 时间平移到从 0 开始
+static AnimClip SliceClip(const AnimClip& src, const std::string& name, double t0, double t1, bool loop) {
+    AnimClip clip;
+    clip.name = name;
+    clip.ticksPerSecond = src.ticksPerSecond;
+    clip.duration = t1 - t0;
+    clip.loop = loop;
+    for (const auto& ch : src.channels) {
+        ClipChannel cc;
+        cc.bone = ch.bone;
+        cc.posKeys = SliceKeys(ch.posKeys, t0, t1, SampleVectorKeys);
+        cc.rotKeys = SliceKeys(ch.rotKeys, t0, t1, SampleQuatKeys);
+        cc.scaleKeys = SliceKeys(ch.scaleKeys, t0, t1, SampleVectorKeys);
+        clip.channels.push_back(std::move(cc));
+    }
+    return clip;
+}
+
+// 读取并校验片段清单: 源动画必须存在, 0 <= start <= end, start 不超过源动画时长 (end 超出时截到结尾)
+static bool LoadClipManifest(const std::string& path, const aiScene* scene, std::vector<ClipRange>& ranges, std::string* error) {
+    auto fail = [&](const std::string& msg) { if (error) *error = msg; return false; };
+    std::ifstream in(path);
+    if (!in) return fail("无法读取");
+    json j = json::parse(in, nullptr, false);
+    if (j.is_discarded() || (!j.is_array() && !j.is_object())) return fail("不是 JSON 数组或对象");
+    const json& list = j.is_array() ? j : j.value("clips", json::array());
+    if (!list.is_array()) return fail("clips 不是数组");
+    // 字段类型不符 (如 "start": "10") 时 value() 抛 type_error, 按清单无效处理
+    try {
+        for (const auto& e : list) {
+            if (!e.is_object()) return fail("条目不是对象");
+            ClipRange r;
+            r.name = e.value("name", std::string());
+            r.source = e.value("source", 0u);
+            r.start = e.value("start", 0.0);
+            r.end = e.value("end", 0.0);
+            r.fps = e.value("fps", 0.0);
+            r.loop = e.value("loop", false);
+            if (r.name.empty()) return fail("条目缺少 name");
+            if (r.start < 0.0 || r.end < r.start) return fail(r.name + ": 帧范围无效 (需要 0 <= start <= end)");
+            if (r.source >= scene->mNumAnimations) return fail(r.name + ": 引用的源动画不存在");
+            const aiAnimation* src = scene->mAnimations[r.source];
+            double ticksPerSecond = src->mTicksPerSecond > 0.0 ? src->mTicksPerSecond : 30.0;
+            double scale = (r.fps > 0.0) ? ticksPerSecond / r.fps : 1.0;
+            if (r.start * scale > src->mDuration) return fail(r.name + ": start 超出源动画时长");
+            ranges.push_back(r);
+        }
+    }
+    catch (const json::exception& ex) { return fail(ex.what()); }
+    return true;
+}
+
+static BonePose SampleChannel(const ClipChannel& ch, double t) {
+    BonePose p;
+    if (!ch.posKeys.empty()) p.t = SampleVectorKeys(ch.posKeys, t);
+    if (!ch.rotKeys.empty()) p.r = SampleQuatKeys(ch.rotKeys, t);
+    if (!ch.scaleKeys.empty()) p.s = SampleVectorKeys(ch.scaleKeys, t);
+    return p;
+}
+
+// 绑定姿态参考: 由 processSkeleton 的 bindLocal 分解得到, 位移换回动画关键帧的原始单位.
+// 根骨骼的 bindLocal 在网格空间, 先去掉祖先变换换回与关键帧相同的父节点空间
+static std::map<std::string, BonePose> BindReferencePose(const std::vector<SkeletonBone>& skeleton) {
+    std::map<std::string, BonePose> ref;
+    for (const auto& b : skeleton) {
+        BonePose p;
+        aiMatrix4x4 local = b.parentId >= 0 ? b.bindLocal : aiMatrix4x4(b.ancestors).Inverse() * b.bindLocal;
+        local.Decompose(p.s, p.r, p.t);
+        p.t *= 1.0f / G_SCALE_FACTOR;
+        ref[b.name] = p;
+    }
+    return ref;
+}
+
+static std::map<std::string, BonePose> ClipReferencePose(const AnimClip& clip, double frame, double fps) {
+    std::map<std::string, BonePose> ref;
+    double t = std::min(frame / fps * clip.ticksPerSecond, clip.duration);
+    for (const auto& ch : clip.channels) ref[ch.bone] = SampleChannel(ch, t);
+    return ref;
+}
+
+// 叠加动画: 每个关键帧换成相对参考姿态的差值 (t - tRef, conj(rRef) * r, s / sRef)
+static void MakeAdditive(AnimClip& clip, const std::map<std::string, BonePose>& ref) {
+    for (auto& ch : clip.channels) {
+        auto it = ref.find(ch.bone);
+        BonePose rp = (it != ref.end()) ? it->second : SampleChannel(ch, 0.0);
+        aiQuaternion inv = rp.r; inv.Conjugate();
+        for (auto& k : ch.posKeys) k.mValue -= rp.t;
+        for (auto& k : ch.rotKeys) {
+            aiQuaternion d = (inv * k.mValue).Normalize();
+            if (d.w < 0.0f) { d.w = -d.w; d.x = -d.x; d.y = -d.y; d.z = -d.z; }
+            k.mValue = d;
+        }
+        for (auto& k : ch.scaleKeys) {
+            k.mValue.x = (std::fabs(rp.s.x) > 1e-6f) ? k.mValue.x / rp.s.x : 1.0f;
+            k.mValue.y = (std::fabs(rp.s.y) > 1e-6f) ? k.mValue.y / rp.s.y : 1.0f;
+            k.mValue.z = (std::fabs(rp.s.z) > 1e-6f) ? k.mValue.z / rp.s.z : 1.0f;
+        }
+    }
+}
+
+template <typename V>
+static std::vector<V> BuildVertices(const aiMesh* mesh, const std::map<std::string, unsigned>& finalBoneMap, WeightStats* stats = nullptr) {
+    std::vector<V> vertices(mesh->mNumVertices);
+    const aiVector3D* texcoords = mesh->HasTextureCoords(0) ? mesh->mTextureCoords[0] : nullptr;
+    const aiVector3D* normals = mesh->HasNormals() ? mesh->mNormals : nullptr;
+    const aiVector3D* tangents = mesh->HasTangentsAndBitangents() ? mesh->mTangents : nullptr;
+    for (unsigned i = 0; i < mesh->mNumVertices; ++i) {
+        V& v = vertices[i];
+        v.position[0] = mesh->mVertices[i].x * G_SCALE_FACTOR;
+        v.position[1] = mesh->mVertices[i].y * G_SCALE_FACTOR;
+        v.position[2] = mesh->mVertices[i].z * G_SCALE_FACTOR;
+        if (texcoords) { v.texcoord[0] = texcoords[i].x; v.texcoord[1] = texcoords[i].y; }
+        if (normals) { v.normal[0] = normals[i].x; v.normal[1] = normals[i].y; v.normal[2] = normals[i].z; }
+        if (tangents) { v.tangent[0] = tangents[i].x; v.tangent[1] = tangents[i].y; v.tangent[2] = tangents[i].z; }
+    }
+    WeightStats ws = AssignBoneWeights(vertices, mesh, finalBoneMap);
+    if (stats) *stats = ws;
+    return vertices;
+}
+
+template <typename Fn>
+static void ParallelFor(size_t count, Fn fn) {
+    size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+    if (threadCount <= 1) { for (size_t i = 0; i < count; ++i) fn(i); return; }
+    std::atomic<size_t> next{ 0 };
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) threads.emplace_back([&]() { for (size_t i; (i = next++) < count;) fn(i); });
+    for (auto& th : threads) th.join();
+}
+
+static inline uint16_t FloatToHalf(float f) {
+    uint32_t x; std::memcpy(&x, &f, 4);
+    uint32_t sign = (x >> 16) & 0x8000u, mant = x & 0x007FFFFFu;
+    int exp = (int)((x >> 23) & 0xFF) - 127 + 15;
+    if (((x >> 23) & 0xFF) == 0xFF) return (uint16_t)(sign | 0x7C00u | (mant ? 0x200u : 0u));
+    if (exp >= 31) return (uint16_t)(sign | 0x7C00u);
+    if (exp <= 0) {
+        if (exp < -10) return (uint16_t)sign;
+        mant |= 0x00800000u;
+        uint32_t shift = (uint32_t)(14 - exp);
+        uint32_t h = mant >> shift;
+        if ((mant >> (shift - 1)) & 1u) h += 1;
+        return (uint16_t)(sign | h);
+    }
+    uint32_t h = sign | ((uint32_t)exp << 10) | (mant >> 13);
+    if (mant & 0x1000u) h += 1;
+    return (uint16_t)h;
+}
+
+// DDS + DX10 扩展头. blockCompressed 时 elementBytes 为每个 4x4 块的字节数, 否则为每像素字节数
+static void WriteDDS(const std::string& path, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t dxgiFormat,
+                     uint32_t elementBytes, bool blockCompressed, const void* data, size_t size) {
+    uint32_t header[32]{};
+    header[0] = 124;
+    header[1] = 0x1 | 0x2 | 0x4 | 0x1000 | (mipCount > 1 ? 0x20000 : 0) | (blockCompressed ? 0x80000 : 0x8);
+    header[2] = height;
+    header[3] = width;
+    header[4] = blockCompressed ? std::max(1u, (width + 3) / 4) * std::max(1u, (height + 3) / 4) * elementBytes : width * elementBytes;
+    header[6] = mipCount;
+    header[18] = 32;
+    header[19] = 0x4;
+    std::memcpy(&header[20], "DX10", 4);
+    header[26] = 0x1000 | (mipCount > 1 ? 0x8 | 0x400000 : 0);
+    uint32_t dx10[5] = { dxgiFormat, 3, 0, 1, 0 };
+    std::ofstream out(path, std::ios::binary);
+    out.write("DDS ", 4);
+    out.write((const char*)header, 124);
+    out.write((const char*)dx10, sizeof(dx10));
+    out.write((const char*)data, size);
+}
+
+static inline aiMatrix4x4 PoseMatrix(const BonePose& p) {
+    aiMatrix4x4 m(p.s, p.r, p.t * G_SCALE_FACTOR);
+    return m;
+}
+
+// 逐帧蒙皮矩阵 (global * offset): 每帧 boneCount 个 3x4 行主序矩阵
+static std::vector<aiMatrix4x4> EvaluateSkinning(const AnimClip& clip, const std::vector<SkeletonBone>& skeleton, unsigned frameCount, double fps) {
+    std::unordered_map<std::string, const ClipChannel*> byName;
+    for (const auto& ch : clip.channels) byName.emplace(ch.bone, &ch);
+    auto channelOf = [&](const std::string& name) -> const ClipChannel* { auto it = byName.find(name); return it != byName.end() ? it->second : nullptr; };
+    std::vector<const ClipChannel*> channels(skeleton.size(), nullptr);
+    std::vector<std::vector<const ClipChannel*>> ancestorChannels(skeleton.size());
+    std::vector<bool> animatedAncestors(skeleton.size(), false);
+    for (size_t b = 0; b < skeleton.size(); ++b) {
+        channels[b] = channelOf(skeleton[b].name);
+        for (const AncestorNode& a : skeleton[b].ancestorNodes) {
+            ancestorChannels[b].push_back(channelOf(a.name));
+            if (ancestorChannels[b].back()) animatedAncestors[b] = true;
+        }
+    }
+    std::vector<aiMatrix4x4> skin((size_t)frameCount * skeleton.size());
+    ParallelFor(frameCount, [&](size_t f) {
+        double t = std::min(f / fps * clip.ticksPerSecond, clip.duration);
+        std::vector<aiMatrix4x4> global(skeleton.size());
+        for (size_t b = 0; b < skeleton.size(); ++b) {
+            // 根骨骼的关键帧相对其父节点, 先乘祖先链换到网格空间; 祖先节点 (Armature / 不带权重的骨骼) 有动画时逐节点采样.
+            // 根的 bindLocal 本身已在网格空间, 因此所有根 (无论有无动画) 都在同一空间
+            aiMatrix4x4 local = skeleton[b].bindLocal;
+            if (skeleton[b].parentId >= 0) { if (channels[b]) local = PoseMatrix(SampleChannel(*channels[b], t)); }
+            else if (channels[b] || animatedAncestors[b]) {
+                aiMatrix4x4 ancestors = skeleton[b].ancestors;
+                if (animatedAncestors[b]) {
+                    ancestors = skeleton[b].meshInverse;
+                    for (size_t a = 0; a < skeleton[b].ancestorNodes.size(); ++a)
+                        ancestors *= ancestorChannels[b][a] ? PoseMatrix(SampleChannel(*ancestorChannels[b][a], t)) : skeleton[b].ancestorNodes[a].local;
+                }
+                // 只有祖先有动画时, 根骨骼自身取绑定姿态在父节点空间中的局部变换
+                local = ancestors * (channels[b] ? PoseMatrix(SampleChannel(*channels[b], t)) : aiMatrix4x4(skeleton[b].ancestors).Inverse() * skeleton[b].bindLocal);
+            }
+            global[b] = skeleton[b].parentId >= 0 ? global[skeleton[b].parentId] * local : local;
+            skin[f * skeleton.size() + b] = global[b] * skeleton[b].offset;
+        }
+    });
+    return skin;
+}
+
+// 逐顶点烘焙用的顶点: 按 MAX_BONE_INFLUENCES 个槽位存放, 实际只填 --max-influences 个 (与导出网格相同的截断与归一化)
+using BakeVertex = VertexT<MAX_BONE_INFLUENCES>;
+
+// --bake-vertices 的烘焙对象: 输出网格 mesh_N 的最终顶点 (去重 / 调色板切分 / 合并之后), 第 v 个与 .mesh 的第 v 个顶点对应
+struct BakeTarget {
+    unsigned mesh = 0;
+    std::vector<BakeVertex> vertices;
+};
+
+const uint32_t MAX_TEXTURE_WIDTH = 16384;  // D3D11 / 常见 GL 实现的纹理宽度上限
+
+static json BakeSkinningTexture(unsigned idx, const AnimClip& clip, const std::vector<SkeletonBone>& skeleton, const BakeTarget* target, const std::string& outDir) {
+    double fps = g_options.sampleRate;
+    unsigned frameCount = (unsigned)std::floor(clip.duration / clip.ticksPerSecond * fps + 1e-6) + 1;
+    size_t boneCount = skeleton.size();
+    json j;
+    if (boneCount * 3 > MAX_TEXTURE_WIDTH) {
+        logln("[Error] anim_" + std::to_string(idx) + ": 骨骼数 " + std::to_string(boneCount) + " 超出蒙皮纹理宽度上限 (每行最多 " + std::to_string(MAX_TEXTURE_WIDTH / 3) + " 根), 未烘焙");
+        return j;
+    }
+    std::vector<aiMatrix4x4> skin = EvaluateSkinning(clip, skeleton, frameCount, fps);
+    j["frameRate"] = fps;
+    j["frameCount"] = frameCount;
+    j["boneCount"] = boneCount;
+    // RGBA16F, 宽 boneCount * 3 (每骨骼 3 行), 高 frameCount
+    std::vector<uint16_t> texels((size_t)frameCount * boneCount * 12);
+    ParallelFor(frameCount, [&](size_t f) {
+        uint16_t* dst = &texels[f * boneCount * 12];
+        for (size_t b = 0; b < boneCount; ++b) {
+            const aiMatrix4x4& m = skin[f * boneCount + b];
+            const float* rows = &m.a1;
+            for (int k = 0; k < 12; ++k) *dst++ = FloatToHalf(rows[k]);
+        }
+    });
+    std::string file = "anim_" + std::to_string(idx) + ".skin.dds";
+    WriteDDS(outDir + "/" + file, (uint32_t)boneCount * 3, frameCount, 1, 10, 8, false, texels.data(), texels.size() * sizeof(uint16_t));
+    j["skinTexture"] = file;
+    if (target && !target->vertices.empty()) {
+        const std::vector<BakeVertex>* vertices = &target->vertices;
+        // 顶点数超过纹理宽度上限时折行: 每帧占 rowsPerFrame 行, 第 v 个顶点位于 (v % width, frame * rowsPerFrame + v / width)
+        size_t vertexCount = vertices->size();
+        uint32_t width = (uint32_t)std::min<size_t>(vertexCount, MAX_TEXTURE_WIDTH);
+        uint32_t rowsPerFrame = (uint32_t)((vertexCount + width - 1) / width);
+        size_t frameTexels = (size_t)width * rowsPerFrame;
+        std::vector<uint16_t> positions((size_t)frameCount * frameTexels * 4);
+        ParallelFor(frameCount, [&](size_t f) {
+            const aiMatrix4x4* palette = &skin[f * boneCount];
+            uint16_t* dst = &positions[f * frameTexels * 4];
+            for (const BakeVertex& v : *vertices) {
+                aiVector3D p(v.position[0], v.position[1], v.position[2]), r;
+                bool skinned = false;
+                for (int i = 0; i < MAX_BONE_INFLUENCES; ++i) {
+                    if (v.boneIDs[i] < 0 || (size_t)v.boneIDs[i] >= boneCount) continue;
+                    r += (palette[v.boneIDs[i]] * p) * v.weights[i];
+                    skinned = true;
+                }
+                if (!skinned) r = p;
+                *dst++ = FloatToHalf(r.x); *dst++ = FloatToHalf(r.y); *dst++ = FloatToHalf(r.z); *dst++ = FloatToHalf(1.0f);
+            }
+        });
+        std::string vfile = "anim_" + std::to_string(idx) + ".mesh_" + std::to_string(target->mesh) + ".vat.dds";
+        WriteDDS(outDir + "/" + vfile, width, frameCount * rowsPerFrame, 1, 10, 8, false, positions.data(), positions.size() * sizeof(uint16_t));
+        j["vertexTexture"] = vfile;
+        j["vertexTextureWidth"] = width;
+        j["vertexRowsPerFrame"] = rowsPerFrame;
+        j["vertexMesh"] = target->mesh;
+    }
+    return j;
+}
+
+// 按 32 位字求和; 各 section 大小都是 4 的倍数, 分段求和与拼接后求和结果相同
+static inline uint64_t ChecksumWords(const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t sum = 0;
+    for (size_t i = 0; i + 4 <= size; i += 4) { uint32_t w; std::memcpy(&w, p + i, 4); sum += w; }
+    return sum;
+}
+
+// 加载对比: ifstream 读出头部后把顶点/索引拷进 vector, 与 MeshView 映射后直接访问 span.
+// 两者都对每个 VERTEX section 的全部字节与所有索引求和, 保证 mmap 一侧也把顶点页真正读入;
+// 文件已在页缓存中, 测的是加载路径本身的开销.
+static void RunLoadBenchmark(const std::string& outDir, unsigned meshCount) {
+    std::vector<std::string> files;
+    uintmax_t totalBytes = 0;
+    for (unsigned i = 0; i < meshCount; ++i) {
+        std::string path = outDir + "/mesh_" + std::to_string(i) + ".mesh";
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(path, ec);
+        if (ec) continue;
+        files.push_back(path);
+        totalBytes += size;
+    }
+    if (files.empty() || totalBytes == 0) return;
+    const int reps = (int)std::max<uintmax_t>(20, 200000000 / totalBytes);
+    auto report = [&](const char* name, double sec, uint64_t checksum) {
+        std::ostringstream ss;
+        ss << "[Bench] load " << name << ": " << sec * 1e6 / ((double)reps * files.size()) << " us/文件, "
+           << (double)totalBytes * reps / sec / 1e9 << " GB/s (checksum " << checksum << ")";
+        logln(ss.str());
+    };
+
+    uint64_t copySum = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) {
+        for (const std::string& path : files) {
+            std::ifstream in(path, std::ios::binary);
+            MeshFileHeader h;
+            in.read((char*)&h, sizeof(h));
+            std::vector<MeshSection> secs(h.sectionCount);
+            in.seekg(h.sectionOffset);
+            in.read((char*)secs.data(), secs.size() * sizeof(MeshSection));
+            std::vector<char> vertices;
+            std::vector<uint32_t> indices;
+            for (const MeshSection& s : secs) {
+                if (s.type == SECTION_VERTEX) {
+                    size_t at = vertices.size();
+                    vertices.resize(at + (size_t)s.elementCount * s.stride);
+                    in.seekg(s.offset);
+                    if (s.encoding == ENCODING_RAW) in.read(vertices.data() + at, s.size);
+                    else {
+                        std::vector<unsigned char> encoded(s.size);
+                        in.read((char*)encoded.data(), s.size);
+                        DecodeVertices(encoded.data(), encoded.size(), (unsigned char*)vertices.data() + at, s.elementCount, s.stride);
+                    }
+                }
+                else if (s.type == SECTION_INDEX) {
+                    indices.resize(s.elementCount);
+                    in.seekg(s.offset);
+                    if (s.encoding == ENCODING_RAW) in.read((char*)indices.data(), s.size);
+                    else {
+                        std::vector<unsigned char> encoded(s.size);
+                        in.read((char*)encoded.data(), s.size);
+                        DecodeIndices(encoded.data(), encoded.size(), indices.data(), indices.size());
+                    }
+                }
+            }
+            copySum += ChecksumWords(vertices.data(), vertices.size());
+            for (uint32_t v : indices) copySum += v;
+        }
+    }
+    report("ifstream+copy", std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(), copySum);
+
+    uint64_t mapSum = 0;
+    std::string error;
+    std::vector<uint32_t> decoded;
+    std::vector<unsigned char> decodedVertices;
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) {
+        for (const std::string& path : files) {
+            MeshView view;
+            if (!view.open(path, &error)) { logln("[Error] " + path + ": " + error); return; }
+            Span<uint32_t> raw = view.indices();
+            if (raw.empty() && view.header().indexCount > 0) {
+                // 压缩的索引/顶点无法零拷贝, 解码到临时缓冲
+                decoded.resize(view.header().indexCount);
+                view.decodeIndices(decoded.data());
+                raw = { decoded.data(), decoded.size() };
+            }
+            for (uint32_t v : raw) mapSum += v;
+            for (const MeshSection& s : view.sections()) {
+                if (s.type != SECTION_VERTEX) continue;
+                if (s.encoding == ENCODING_RAW) { Span<unsigned char> b = view.bytes(s); mapSum += ChecksumWords(b.data(), b.size()); continue; }
+                decodedVertices.resize((size_t)s.elementCount * s.stride);
+                view.decodeVertices(s, decodedVertices.data());
+                mapSum += ChecksumWords(decodedVertices.data(), decodedVertices.size());
+            }
+        }
+    }
+    report("mmap", std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(), mapSum);
+}
+
+// 索引编解码: 对输出的各网格索引 (先解码成原始索引) 重新编码, 比较标量与 SSSE3 解码吞吐并校验结果
+static void RunIndexCodecBenchmark(const std::string& outDir, unsigned meshCount) {
+    std::vector<uint32_t> indices;
+    for (unsigned i = 0; i < meshCount; ++i) {
+        MeshView view;
+        if (!view.open(outDir + "/mesh_" + std::to_string(i) + ".mesh")) continue;
+        size_t at = indices.size();
+        indices.resize(at + view.header().indexCount);
+        view.decodeIndices(indices.data() + at);
+    }
+    if (indices.empty()) return;
+    std::vector<unsigned char> encoded = EncodeIndices(indices.data(), indices.size());
+    {
+        std::ostringstream ss;
+        ss << "[Bench] index codec: " << indices.size() * 4 << " -> " << encoded.size() << " 字节 ("
+           << encoded.size() * 100.0 / (indices.size() * 4) << "%)";
+        logln(ss.str());
+    }
+    typedef bool (*IndexDecoder)(const unsigned char*, size_t, uint32_t*, size_t);
+    std::vector<std::pair<const char*, IndexDecoder>> decoders = { { "scalar", DecodeIndicesScalar } };
+#if defined(MC_X86)
+    if (CpuHasSSSE3()) decoders.push_back({ "ssse3", DecodeIndicesSSSE3 });
+#endif
+    const int reps = (int)std::max<size_t>(1, 100000000 / indices.size());
+    std::vector<uint32_t> out(indices.size());
+    for (const auto& d : decoders) {
+        auto t0 = std::chrono::steady_clock::now();
+        bool ok = true;
+        for (int r = 0; r < reps; ++r) ok &= d.second(encoded.data(), encoded.size(), out.data(), out.size());
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        ok &= out == indices;
+        std::ostringstream ss;
+        ss << "[Bench] index decode " << d.first << ": " << (double)indices.size() * 4 * reps / sec / 1e9 << " GB/s (解码后)" << (ok ? "" : " (结果不一致!)");
+        logln(ss.str());
+    }
+}
+
+// 顶点编解码: 对输出的各 VERTEX section (先解码成原始数据) 重新编码, 比较标量与 SSSE3 解码吞吐并校验结果
+static void RunVertexCodecBenchmark(const std::string& outDir, unsigned meshCount) {
+    struct Stream { uint32_t count, stride; std::vector<unsigned char> raw, encoded; };
+    std::vector<Stream> streams;
+    size_t rawBytes = 0, encodedBytes = 0;
+    for (unsigned i = 0; i < meshCount; ++i) {
+        MeshView view;
+        if (!view.open(outDir + "/mesh_" + std::to_string(i) + ".mesh")) continue;
+        for (const MeshSection& s : view.sections()) {
+            if (s.type != SECTION_VERTEX || s.elementCount == 0) continue;
+            Stream st{ s.elementCount, s.stride, std::vector<unsigned char>((size_t)s.elementCount * s.stride), {} };
+            view.decodeVertices(s, st.raw.data());
+            st.encoded = EncodeVertices(st.raw.data(), st.count, st.stride);
+            rawBytes += st.raw.size();
+            encodedBytes += st.encoded.size();
+            streams.push_back(std::move(st));
+        }
+    }
+    if (rawBytes == 0) return;
+    {
+        std::ostringstream ss;
+        ss << "[Bench] vertex codec: " << rawBytes << " -> " << encodedBytes << " 字节 (" << encodedBytes * 100.0 / rawBytes << "%)";
+        logln(ss.str());
+    }
+    typedef bool (*VertexDecoder)(const unsigned char*, size_t, unsigned char*, size_t, size_t);
+    std::vector<std::pair<const char*, VertexDecoder>> decoders = { { "scalar", DecodeVerticesScalar } };
+#if defined(MC_X86)
+    if (CpuHasSSSE3()) decoders.push_back({ "ssse3", DecodeVerticesSSSE3 });
+#endif
+    const int reps = (int)std::max<size_t>(1, 200000000 / rawBytes);
+    std::vector<unsigned char> out;
+    for (const auto& d : decoders) {
+        bool ok = true;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            for (const Stream& st : streams) {
+                out.resize(st.raw.size());
+                ok &= d.second(st.encoded.data(), st.encoded.size(), out.data(), st.count, st.stride);
+            }
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        for (const Stream& st : streams) {
+            out.resize(st.raw.size());
+            d.second(st.encoded.data(), st.encoded.size(), out.data(), st.count, st.stride);
+            ok &= out == st.raw;
+        }
+        std::ostringstream ss;
+        ss << "[Bench] vertex decode " << d.first << ": " << (double)rawBytes * reps / sec / 1e9 << " GB/s (解码后)" << (ok ? "" : " (结果不一致!)");
+        logln(ss.str());
+    }
+}
+
+// ---- 输出文件整体压缩 (--compress) ----
+
+static bool CompressBuffer(const std::string& codec, int level, const std::vector<char>& in, std::vector<char>& out) {
+#if defined(MC_HAVE_ZSTD)
+    if (codec == "zstd") {
+        out.resize(ZSTD_compressBound(in.size()));
+        size_t n = ZSTD_compress(out.data(), out.size(), in.data(), in.size(), level);
+        if (ZSTD_isError(n)) return false;
+        out.resize(n);
+        return true;
+    }
+#endif
+#if defined(MC_HAVE_LZ4)
+    if (codec == "lz4") {
+        LZ4F_preferences_t prefs{};
+        prefs.compressionLevel = level;   // >= 3 走 HC
+        prefs.frameInfo.contentSize = in.size();
+        out.resize(LZ4F_compressFrameBound(in.size(), &prefs));
+        size_t n = LZ4F_compressFrame(out.data(), out.size(), in.data(), in.size(), &prefs);
+        if (LZ4F_isError(n)) return false;
+        out.resize(n);
+        return true;
+    }
+#endif
+#if !defined(MC_HAVE_ZSTD) && !defined(MC_HAVE_LZ4)
+    (void)codec; (void)level; (void)in; (void)out;
+#endif
+    return false;
+}
+
+// 解压到 out[rawSize]
+static bool DecompressBuffer(const std::string& codec, const char* in, size_t size, char* out, size_t rawSize) {
+#if defined(MC_HAVE_ZSTD)
+    if (codec == "zstd") return ZSTD_decompress(out, rawSize, in, size) == rawSize;
+#endif
+#if defined(MC_HAVE_LZ4)
+    if (codec == "lz4") {
+        LZ4F_dctx* ctx = nullptr;
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&ctx, LZ4F_VERSION))) return false;
+        size_t dstSize = rawSize, srcSize = size;
+        size_t r = LZ4F_decompress(ctx, out, &dstSize, in, &srcSize, nullptr);
+        LZ4F_freeDecompressionContext(ctx);
+        return r == 0 && dstSize == rawSize;
+    }
+#endif
+#if !defined(MC_HAVE_ZSTD) && !defined(MC_HAVE_LZ4)
+    (void)codec; (void)in; (void)size; (void)out; (void)rawSize;
+#endif
+    return false;
+}
+
+static bool ReadFileBytes(const std::string& path, std::vector<char>& data) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    data.resize((size_t)in.tellg());
+    in.seekg(0);
+    return (bool)in.read(data.data(), (std::streamsize)data.size());
+}
+
+// 多线程压缩本次转换写出的各文件 (files 为相对 outDir 的文件名, 不含 scene.json), 写成 <文件>.zst / .lz4 并删除原文件;
+// 输出目录中的其他文件不动. 压缩后不变小的文件 (如已压缩的 png) 保持原样. 返回写入 scene.json 的 compression 记录:
+// { codec, level, files: { 原文件名: { file, size, compressedSize } } }
+static json CompressArtifacts(const std::string& outDir, std::vector<std::string> names) {
+    const std::string& codec = g_options.compressCodec;
+    const std::string ext = codec == "zstd" ? ".zst" : ".lz4";
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    struct Result { bool compressed = false; size_t size = 0, compressedSize = 0; };
+    std::vector<Result> results(names.size());
+    std::atomic<unsigned> failures{ 0 };
+    auto t0 = std::chrono::steady_clock::now();
+    ParallelFor(names.size(), [&](size_t i) {
+        std::string path = outDir + "/" + names[i];
+        std::vector<char> raw, packed;
+        if (!ReadFileBytes(path, raw) || !CompressBuffer(codec, g_options.compressLevel, raw, packed)) { ++failures; return; }
+        results[i].size = raw.size();
+        if (packed.size() >= raw.size()) return;
+        std::ofstream out(path + ext, std::ios::binary);
+        out.write(packed.data(), (std::streamsize)packed.size());
+        out.close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        results[i].compressed = true;
+        results[i].compressedSize = packed.size();
+    });
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (failures > 0) logln("[Warn] " + std::to_string(failures.load()) + " 个文件压缩失败, 保持未压缩");
+
+    json j;
+    j["codec"] = codec;
+    j["level"] = g_options.compressLevel;
+    j["files"] = json::object();
+    size_t rawTotal = 0, packedTotal = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+        rawTotal += results[i].size;
+        packedTotal += results[i].compressed ? results[i].compressedSize : results[i].size;
+        if (results[i].compressed)
+            j["files"][names[i]] = { {"file", names[i] + ext}, {"size", results[i].size}, {"compressedSize", results[i].compressedSize} };
+    }
+    std::ostringstream ss;
+    ss << "[Info] " << codec << ":" << g_options.compressLevel << " 压缩 " << j["files"].size() << "/" << names.size() << " 个文件, "
+       << rawTotal << " -> " << packedTotal << " 字节 (" << (rawTotal ? packedTotal * 100.0 / rawTotal : 100.0) << "%), " << sec * 1000.0 << " ms";
+    logln(ss.str());
+
+    if (g_options.benchmark) {
+        // 解压吞吐: 单线程依次解压全部压缩文件, 按解压后的字节计
+        std::vector<std::vector<char>> packed;
+        std::vector<size_t> sizes;
+        for (auto it = j["files"].begin(); it != j["files"].end(); ++it) {
+            packed.emplace_back();
+            if (!ReadFileBytes(outDir + "/" + it.value()["file"].get<std::string>(), packed.back())) { packed.pop_back(); continue; }
+            sizes.push_back(it.value()["size"].get<size_t>());
+        }
+        size_t total = 0;
+        for (size_t n : sizes) total += n;
+        if (total > 0) {
+            const int reps = (int)std::max<size_t>(1, 200000000 / total);
+            std::vector<char> out;
+            bool ok = true;
+            auto t1 = std::chrono::steady_clock::now();
+            for (int r = 0; r < reps; ++r) {
+                for (size_t i = 0; i < packed.size(); ++i) {
+                    out.resize(sizes[i]);
+                    ok &= DecompressBuffer(codec, packed[i].data(), packed[i].size(), out.data(), sizes[i]);
+                }
+            }
+            double dsec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+            std::ostringstream bs;
+            bs << "[Bench] " << codec << " decode: " << (double)total * reps / dsec / 1e9 << " GB/s (解压后)" << (ok ? "" : " (解压失败!)");
+            logln(bs.str());
         }
     }
+    return j;
+}
+
+// ---- 纹理 (--textures) ----
+
+static bool DecodeImage(const unsigned char* data, size_t size, Image& img) {
+#if defined(MC_HAVE_STB)
+    int w = 0, h = 0, comp = 0;
+    unsigned char* pixels = stbi_load_from_memory(data, (int)size, &w, &h, &comp, 4);
+    if (!pixels) return false;
+    img.width = (uint32_t)w;
+    img.height = (uint32_t)h;
+    img.rgba.assign(pixels, pixels + (size_t)w * h * 4);
+    stbi_image_free(pixels);
+    return true;
+#else
+    (void)data; (void)size; (void)img;
     return false;
+#endif
 }
 
-void processMesh(unsigned, const aiMesh*, const std::string&, const std::map<std::string, unsigned>&);
-void processMaterial(unsigned int, const aiMaterial*, const aiScene*, const std::string&);
-void processSkeleton(const aiScene*, const std::string&, std::map<std::string, unsigned>&, std::map<std::string, unsigned>&);
-void processAnimation(unsigned, const aiAnimation*, const std::string&);
-void createSceneFile(const aiScene*, const std::string&);
+static bool LoadImageFile(const std::string& path, Image& img) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::vector<unsigned char> data((size_t)in.tellg());
+    in.seekg(0);
+    in.read((char*)data.data(), (std::streamsize)data.size());
+    return DecodeImage(data.data(), data.size(), img);
+}
+
+// 材质纹理槽. 颜色类为 sRGB, 法线用 BC5 (仅 RG), 其余数据贴图按线性处理; types 按顺序取第一个存在的
+struct TextureSlot {
+    const char* key;
+    aiTextureType types[2];
+    bool srgb;
+    bool normalMap;
+};
+
+static const TextureSlot TEXTURE_SLOTS[] = {
+    { "diffuseTexture",   { aiTextureType_DIFFUSE, aiTextureType_NONE },                     true,  false },
+    { "baseColorTexture", { aiTextureType_BASE_COLOR, aiTextureType_NONE },                  true,  false },
+    { "normalTexture",    { aiTextureType_NORMALS, aiTextureType_NORMAL_CAMERA },            false, true  },
+    { "metallicTexture",  { aiTextureType_METALNESS, aiTextureType_NONE },                   false, false },
+    { "roughnessTexture", { aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_NONE },           false, false },
+    { "emissiveTexture",  { aiTextureType_EMISSIVE, aiTextureType_EMISSION_COLOR },          true,  false },
+    { "occlusionTexture", { aiTextureType_AMBIENT_OCCLUSION, aiTextureType_LIGHTMAP },       false, false },
+};
+
+// 一张输出纹理. 同一来源 + 同一处理方式 (srgb / normalMap) 在所有材质间只处理一次
+struct TextureJob {
+    std::string source;          // "*N" 为内嵌纹理, 否则为材质里的路径
+    bool srgb = true;
+    bool normalMap = false;
+    std::string output;          // 处理后的文件名, 为空表示无输出
+    std::vector<Image> mips;
+    std::vector<size_t> offsets; // 各级 mip 在 data 中的偏移
+    std::vector<uint8_t> data;
+    uint32_t format = 0;
+};
+
+struct TextureTable {
+    std::vector<TextureJob> jobs;
+    std::map<std::string, size_t> lookup;
+
+    size_t request(const std::string& source, const TextureSlot& slot) {
+        std::string key = source + (slot.normalMap ? "|normal" : slot.srgb ? "|srgb" : "|linear");
+        auto it = lookup.find(key);
+        if (it != lookup.end()) return it->second;
+        TextureJob job;
+        job.source = source;
+        job.srgb = slot.srgb;
+        job.normalMap = slot.normalMap;
+        jobs.push_back(std::move(job));
+        return lookup[key] = jobs.size() - 1;
+    }
+};
+
+// 去重后的一个输出材质: props 中的纹理槽为 TextureTable 下标
+struct MaterialEntry {
+    std::string name;
+    json props;
+};
+
+// 未指定 --textures 时 (只有未压缩的内嵌纹理会走到这里) 输出 RGBA8
+static uint32_t TextureFormatFor(const TextureJob& job) {
+    if (g_options.textureFormat.empty()) return job.srgb ? DXGI_R8G8B8A8_UNORM_SRGB : DXGI_R8G8B8A8_UNORM;
+    if (job.normalMap) return DXGI_BC5_UNORM;
+    if (g_options.textureFormat == "bc1") return job.srgb ? DXGI_BC1_UNORM_SRGB : DXGI_BC1_UNORM;
+    if (g_options.textureFormat == "bc3") return job.srgb ? DXGI_BC3_UNORM_SRGB : DXGI_BC3_UNORM;
+    return job.srgb ? DXGI_BC7_UNORM_SRGB : DXGI_BC7_UNORM;
+}
+
+static const aiTexture* EmbeddedTexture(const TextureJob& job, const aiScene* scene) {
+    if (job.source.rfind('*', 0) != 0) return nullptr;
+    int textureIndex = std::stoi(job.source.substr(1));
+    return (scene && textureIndex >= 0 && textureIndex < (int)scene->mNumTextures) ? scene->mTextures[textureIndex] : nullptr;
+}
+
+// mHeight != 0 的内嵌纹理是 mWidth * mHeight 个 aiTexel (内存中 BGRA), 直接换成 RGBA, 不经过图片编解码
+static bool IsRawEmbedded(const TextureJob& job, const aiScene* scene) {
+    const aiTexture* tex = EmbeddedTexture(job, scene);
+    return tex && tex->mHeight != 0;
+}
+
+static bool LoadTextureSource(const TextureJob& job, const aiScene* scene, const std::string& inputDir, Image& img) {
+    if (job.source.rfind('*', 0) == 0) {
+        const aiTexture* embeddedTexture = EmbeddedTexture(job, scene);
+        if (!embeddedTexture) return false;
+        if (embeddedTexture->mHeight == 0) return DecodeImage((const unsigned char*)embeddedTexture->pcData, embeddedTexture->mWidth, img);
+        img.width = embeddedTexture->mWidth;
+        img.height = embeddedTexture->mHeight;
+        img.rgba.resize((size_t)img.width * img.height * 4);
+        for (size_t i = 0; i < (size_t)img.width * img.height; ++i) {
+            const aiTexel& t = embeddedTexture->pcData[i];
+            uint8_t* o = &img.rgba[i * 4];
+            o[0] = t.r; o[1] = t.g; o[2] = t.b; o[3] = t.a;
+        }
+        return true;
+    }
+    // 先按相对路径找, 再按文件名在模型目录下找 (FBX 里常是美术机器上的绝对路径)
+    return LoadImageFile((std::filesystem::path(inputDir) / job.source).string(), img) ||
+           LoadImageFile((std::filesystem::path(inputDir) / std::filesystem::path(job.source).filename()).string(), img);
+}
+
+// 不转码时的原样输出: 内嵌压缩纹理按格式提示写出为 texture_<内嵌纹理序号>, 外部纹理只记录文件名; 返回是否在 outDir 中写出了文件
+static bool CopyTextureSource(TextureJob& job, const aiScene* scene, const std::string& outDir) {
+    if (job.source.rfind('*', 0) != 0) { job.output = std::filesystem::path(job.source).filename().string(); return false; }
+    const aiTexture* embeddedTexture = EmbeddedTexture(job, scene);
+    if (!embeddedTexture || embeddedTexture->mHeight != 0) return false;
+    std::string extension = "png"; if (embeddedTexture->achFormatHint[0] != 0) { extension = embeddedTexture->achFormatHint; }
+    job.output = "texture_" + job.source.substr(1) + "." + extension;
+    std::ofstream textureFile(outDir + "/" + job.output, std::ios::binary);
+    textureFile.write(reinterpret_cast<const char*>(embeddedTexture->pcData), embeddedTexture->mWidth);
+    return true;
+}
+
+const size_t MAX_TEXTURE_BATCH_BYTES = (size_t)512 << 20;  // 一批已解码 mip 链的内存上限
+
+// 所有材质共用的纹理处理: 按批并行解码并生成 mip, 再把该批所有纹理所有 mip 的块行放进同一个任务队列并行压缩, 写出 DDS 后释放.
+// 每批按线程数分块解码, 已解码的 mip 链累计超过 MAX_TEXTURE_BATCH_BYTES 即截断, 内存占用不随纹理总数增长.
+// 未压缩的内嵌纹理总是转成 DDS (未指定 --textures 时为 RGBA8 + mip); 其余纹理在未指定 --textures 或解码失败时原样输出,
+// 同一源只输出一次 (颜色 / 法线等不同用途共用一份). 返回写出的文件 (相对 outDir).
+static std::vector<std::string> ProcessTextures(TextureTable& textures, const aiScene* scene, const std::string& outDir, const std::string& inputDir) {
+    std::vector<TextureJob>& jobs = textures.jobs;
+    std::vector<std::string> written;
+    if (jobs.empty()) return written;
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<char> decoded(jobs.size(), 0);
+    std::map<std::string, std::string> copied;   // 原样输出: 源 -> 输出文件名
+    const size_t chunk = std::max(1u, std::thread::hardware_concurrency());
+    size_t converted = 0;
+    for (size_t begin = 0, end = 0; begin < jobs.size(); begin = end) {
+        size_t batchBytes = 0;
+        while (end < jobs.size() && batchBytes < MAX_TEXTURE_BATCH_BYTES) {
+            size_t first = end;
+            end = std::min(jobs.size(), end + chunk);
+            ParallelFor(end - first, [&](size_t k) {
+                size_t i = first + k;
+                Image img;
+                if (g_options.textureFormat.empty() && !IsRawEmbedded(jobs[i], scene)) return;
+                if (!LoadTextureSource(jobs[i], scene, inputDir, img)) return;
+                jobs[i].mips = BuildMipChain(std::move(img), jobs[i].srgb, jobs[i].normalMap);
+                decoded[i] = 1;
+            });
+            for (size_t i = first; i < end; ++i)
+                for (const Image& m : jobs[i].mips) batchBytes += m.rgba.size();
+        }
+
+        struct BlockRow { size_t job, level; uint32_t row; };
+        std::vector<BlockRow> rows;
+        for (size_t i = begin; i < end; ++i) {
+            TextureJob& job = jobs[i];
+            if (!decoded[i]) {
+                auto it = copied.find(job.source);
+                if (it != copied.end()) { job.output = it->second; continue; }
+                if (!g_options.textureFormat.empty()) logln("[Warn] 无法解码纹理 " + job.source + ", 按原样输出");
+                if (CopyTextureSource(job, scene, outDir)) written.push_back(job.output);
+                copied[job.source] = job.output;
+                continue;
+            }
+            job.format = TextureFormatFor(job);
+            if (!IsBlockCompressed(job.format)) {
+                for (const Image& m : job.mips) job.data.insert(job.data.end(), m.rgba.begin(), m.rgba.end());
+            }
+            else {
+                size_t total = 0;
+                for (size_t level = 0; level < job.mips.size(); ++level) {
+                    const Image& m = job.mips[level];
+                    job.offsets.push_back(total);
+                    total += (size_t)((m.width + 3) / 4) * ((m.height + 3) / 4) * BlockBytes(job.format);
+                    for (uint32_t by = 0; by < (m.height + 3) / 4; ++by) rows.push_back({ i, level, by });
+                }
+                job.data.resize(total);
+            }
+            job.output = "texture_" + std::to_string(i) + ".dds";
+        }
+        ParallelFor(rows.size(), [&](size_t r) {
+            TextureJob& job = jobs[rows[r].job];
+            const Image& m = job.mips[rows[r].level];
+            size_t rowBytes = (size_t)((m.width + 3) / 4) * BlockBytes(job.format);
+            EncodeBlockRow(m, job.format, rows[r].row, job.data.data() + job.offsets[rows[r].level] + rows[r].row * rowBytes);
+        });
+        for (size_t i = begin; i < end; ++i) {
+            TextureJob& job = jobs[i];
+            if (!decoded[i]) continue;
+            bool compressed = IsBlockCompressed(job.format);
+            WriteDDS(outDir + "/" + job.output, job.mips[0].width, job.mips[0].height, (uint32_t)job.mips.size(), job.format,
+                     compressed ? BlockBytes(job.format) : 4, compressed, job.data.data(), job.data.size());
+            written.push_back(job.output);
+            std::vector<Image>().swap(job.mips);
+            std::vector<uint8_t>().swap(job.data);
+            ++converted;
+        }
+    }
+    if (converted > 0) {
+        std::ostringstream ss;
+        ss << "[Info] 纹理: " << converted << "/" << jobs.size() << " 张转码为 DDS, "
+           << std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() * 1000.0 << " ms";
+        logln(ss.str());
+    }
+    return written;
+}
+
+static bool ParseOptions(int argc, char* argv[], ConvertOptions& opt) {
+    for (int i = 2; i < argc; ++i) try {
+        std::string a = argv[i];
+        auto value = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (a == "--sample-rate" && (v = value())) {
+            opt.sampleRate = std::atof(v);
+            if (opt.sampleRate <= 0.0) { std::cerr << "错误: --sample-rate 应为正数: " << v << "\n"; return false; }
+        }
+        else if (a == "--root-motion" && (v = value())) opt.rootMotionBone = v;
+        else if (a == "--root-motion-mode" && (v = value())) {
+            std::string m = v;
+            if (m == "inplace") opt.rootMotionInPlace = true;
+            else if (m == "zero") opt.rootMotionInPlace = false;
+            else { std::cerr << "错误: --root-motion-mode 应为 inplace 或 zero: " << m << "\n"; return false; }
+        }
+        else if (a == "--additive" && (v = value())) {
+            std::string list = v;
+            if (list == "all") { opt.additiveAll = true; continue; }
+            std::stringstream ss(list); std::string item;
+            while (std::getline(ss, item, ',')) {
+                if (item.empty()) continue;
+                int clip = std::stoi(item);
+                if (clip < 0) throw std::invalid_argument(item);
+                opt.additiveClips.insert((unsigned)clip);
+            }
+        }
+        else if (a == "--clips" && (v = value())) opt.clipManifest = v;
+        else if (a == "--bake-skinning") opt.bakeSkinning = true;
+        else if (a == "--benchmark") opt.benchmark = true;
+        else if (a == "--split-streams") opt.splitStreams = true;
+        else if (a == "--dedup") opt.dedup = true;
+        else if (a == "--merge-by-material") opt.mergeByMaterial = true;
+        else if (a == "--bake-transforms") opt.bakeTransforms = true;
+        else if (a == "--instance-geometry") opt.instanceGeometry = true;
+        else if (a == "--compress-indices") opt.compressIndices = true;
+        else if (a == "--compress-vertices") opt.compressVertices = true;
+        else if (a == "--textures" && (v = value())) {
+            opt.textureFormat = v;
+            if (opt.textureFormat != "bc1" && opt.textureFormat != "bc3" && opt.textureFormat != "bc7") { std::cerr << "错误: --textures 应为 bc1, bc3 或 bc7: " << v << "\n"; return false; }
+#if !defined(MC_HAVE_STB)
+            std::cerr << "错误: 未启用纹理解码 (编译时未找到 stb_image), 不能使用 --textures\n";
+            return false;
+#endif
+        }
+        else if (a == "--compress" && (v = value())) {
+            std::string spec = v;
+            size_t colon = spec.find(':');
+            opt.compressCodec = spec.substr(0, colon);
+            if (opt.compressCodec == "zstd") opt.compressLevel = 3;
+            else if (opt.compressCodec == "lz4") opt.compressLevel = 0;
+            else { std::cerr << "错误: --compress 应为 zstd 或 lz4: " << opt.compressCodec << "\n"; return false; }
+            if (colon != std::string::npos) opt.compressLevel = std::stoi(spec.substr(colon + 1));
+#if defined(MC_HAVE_ZSTD)
+            if (opt.compressCodec == "zstd" && (opt.compressLevel < ZSTD_minCLevel() || opt.compressLevel > ZSTD_maxCLevel())) {
+                std::cerr << "错误: zstd 压缩级别应在 " << ZSTD_minCLevel() << ".." << ZSTD_maxCLevel() << " 之间\n";
+                return false;
+            }
+#else
+            if (opt.compressCodec == "zstd") { std::cerr << "错误: 未启用 zstd 支持 (编译时未找到 zstd)\n"; return false; }
+#endif
+#if defined(MC_HAVE_LZ4)
+            // LZ4F 会把超过 LZ4HC_CLEVEL_MAX (12) 的级别静默截断, 负数为快速模式; 这里只接受 0..12
+            if (opt.compressCodec == "lz4" && (opt.compressLevel < 0 || opt.compressLevel > 12)) {
+                std::cerr << "错误: lz4 压缩级别应在 0..12 之间\n";
+                return false;
+            }
+#else
+            if (opt.compressCodec == "lz4") { std::cerr << "错误: 未启用 lz4 支持 (编译时未找到 lz4)\n"; return false; }
+#endif
+        }
+        else if (a == "--bone-palette" && (v = value())) {
+            int palette = std::stoi(v);
+            if (palette <= 0) throw std::invalid_argument(v);
+            opt.bonePalette = (unsigned)palette;
+        }
+        else if (a == "--max-influences" && (v = value())) {
+            opt.maxInfluences = std::stoi(v);
+            if (opt.maxInfluences != 2 && opt.maxInfluences != 4 && opt.maxInfluences != 8) { std::cerr << "错误: --max-influences 应为 2, 4 或 8: " << v << "\n"; return false; }
+        }
+        else if (a == "--bake-vertices" && (v = value())) { opt.bakeSkinning = true; opt.bakeVertexMesh = std::stoi(v); }
+        else if (a == "--additive-ref" && (v = value())) {
+            std::string r = v;
+            if (r == "bind") opt.additiveRefClip = -1;
+            else {
+                size_t colon = r.find(':');
+                opt.additiveRefClip = std::stoi(r.substr(0, colon));
+                opt.additiveRefFrame = (colon == std::string::npos) ? 0.0 : std::stod(r.substr(colon + 1));
+                if (opt.additiveRefClip < 0 || opt.additiveRefFrame < 0.0) throw std::invalid_argument(r);
+            }
+        }
+        else { std::cerr << "错误: 无法解析选项: " << a << "\n"; return false; }
+    }
+    catch (const std::exception&) { std::cerr << "错误: 选项参数无效: " << argv[i] << "\n"; return false; }
+    return true;
+}
+
+// 输出网格的 scene.json 条目, 以及每个源网格 (aiMesh 下标) 最终落在哪个输出网格 / SubMesh
+struct MeshOutputs {
+    std::vector<json> entries;
+    std::vector<NodeMeshRef> sources;
+    std::vector<MeshInstance> instances;   // 仅 --bake-transforms / --instance-geometry
+    BakeTarget bake;                       // 仅 --bake-vertices
+};
+
+MeshOutputs processMeshes(const aiScene*, const std::string&, const std::map<std::string, unsigned>&, const std::vector<SkeletonBone>&, const std::vector<unsigned>&);
+std::string processNodes(const aiScene*, const std::string&, const std::vector<NodeMeshRef>&);
+std::string processInstances(const std::string&, const std::vector<MeshInstance>&);
+std::string processSkeleton(const aiScene*, const std::string&, std::map<std::string, unsigned>&, std::map<std::string, unsigned>&, std::vector<SkeletonBone>&);
+std::vector<std::string> processAnimation(unsigned, AnimClip, const std::string&, const std::map<std::string, BonePose>*, const std::vector<SkeletonBone>&, const BakeTarget*, const aiMatrix4x4&);
+std::vector<MaterialEntry> collectMaterials(const aiScene*, TextureTable&, std::vector<unsigned>&);
+std::string writeMaterialTable(const std::vector<MaterialEntry>&, const TextureTable&, const std::string&);
+void createSceneFile(const std::string&, const std::vector<json>&, size_t, unsigned, const json&);
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "用法: ModelConverter.exe <输入文件.fbx>\n";
+        std::cerr << "用法: ModelConverter.exe <输入文件.fbx> [选项]\n"
+                     "  --sample-rate <fps>               逐帧采样频率 (默认 30)\n"
+                     "  --root-motion <bone>              提取根运动到独立轨道\n"
+                     "  --root-motion-mode inplace|zero   根通道处理方式 (默认 inplace)\n"
+                     "  --clips <manifest.json>           按帧范围清单把源动画切成多个片段\n"
+                     "  --additive <i,j,...|all>          输出为叠加动画的片段 (输出片段序号)\n"
+                     "  --additive-ref bind|<anim>:<frame> 叠加动画参考姿态 (默认 bind)\n"
+                     "  --bake-skinning                   烘焙每帧蒙皮矩阵纹理 (RGBA16F DDS)\n"
+                     "  --bake-vertices <mesh>            同时烘焙该网格的逐顶点位置纹理\n"
+                     "  --max-influences 2|4|8            每顶点骨骼影响数 (默认 4)\n"
+                     "  --bone-palette <N>                按每批最多 N 根骨骼切分蒙皮网格\n"
+                     "  --split-streams                   顶点拆成位置/着色/蒙皮三个独立对齐的流\n"
+                     "  --dedup                           按最终顶点数据去重并重映射索引\n"
+                     "  --merge-by-material               合并同材质的静态网格以减少 draw call\n"
+                     "  --bake-transforms                 静态网格烘焙世界变换, 多次引用的网格输出为实例列表\n"
+                     "  --instance-geometry               按几何哈希合并相同的静态网格, 输出网格 ID + 节点变换实例\n"
+                     "  --compress-indices                索引压缩存储 (差分 + Stream VByte)\n"
+                     "  --compress-vertices               顶点压缩存储 (字节平面差分, 无损)\n"
+                     "  --compress zstd|lz4[:level]       输出文件整体压缩, 记录在 scene.json 的 compression\n"
+                     "  --textures bc1|bc3|bc7            纹理解码后生成 mip 并块压缩为 DDS\n"
+                     "  --benchmark                       输出索引/顶点解码内核的吞吐对比, 以及 .mesh 的 mmap / ifstream 加载对比\n";
         return 1;
     }
+    if (!ParseOptions(argc, argv, g_options)) return 1;
 
     std::filesystem::path inPath(argv[1]);
     if (!std::filesystem::exists(inPath)) { std::cerr << "错误: 文件不存在: " << inPath << "\n"; return 1; }
@@ -102,8 +1361,6 @@ int main(int argc, char* argv[]) {
     std::string outDir = inPath.stem().string();
     std::filesystem::create_directories(outDir);
 
-    auto logln = [](const std::string& s) { std::cout << s << std::endl; };
-
     logln("[Info] Input : " + abs.string());
     logln("[Info] Output: " + std::filesystem::absolute(outDir).string());
 
@@ -112,6 +1369,40 @@ int main(int argc, char* argv[]) {
     const aiScene* scene = importer.ReadFile(abs.u8string(), flags);
     if (!scene) { logln(std::string("[Error] Assimp: ") + importer.GetErrorString()); return 1; }
 
+    // 在写出任何文件之前校验引用网格/片段的选项, 避免留下半写的输出目录
+    if (g_options.bakeVertexMesh >= 0 && (unsigned)g_options.bakeVertexMesh >= scene->mNumMeshes) {
+        logln("[Error] --bake-vertices 网格不存在: " + std::to_string(g_options.bakeVertexMesh));
+        return 1;
+    }
+    if (g_options.additiveRefClip >= 0 && (unsigned)g_options.additiveRefClip >= scene->mNumAnimations) {
+        logln("[Error] --additive-ref 片段不存在: " + std::to_string(g_options.additiveRefClip));
+        return 1;
+    }
+
+    std::vector<AnimClip> clips;
+    if (!g_options.clipManifest.empty()) {
+        std::vector<ClipRange> ranges;
+        std::string error;
+        if (!LoadClipManifest(g_options.clipManifest, scene, ranges, &error)) { logln("[Error] 片段清单无效: " + g_options.clipManifest + ": " + error); return 1; }
+        std::map<unsigned, AnimClip> sources;
+        for (const auto& r : ranges) {
+            auto it = sources.find(r.source);
+            if (it == sources.end()) it = sources.emplace(r.source, LoadClip(r.source, scene->mAnimations[r.source])).first;
+            const AnimClip& src = it->second;
+            double scale = (r.fps > 0.0) ? src.ticksPerSecond / r.fps : 1.0;
+            double t0 = std::min(r.start * scale, src.duration), t1 = std::min(r.end * scale, src.duration);
+            clips.push_back(SliceClip(src, r.name, t0, t1, r.loop));
+        }
+    }
+    else {
+        for (unsigned i = 0; i < scene->mNumAnimations; ++i) clips.push_back(LoadClip(i, scene->mAnimations[i]));
+    }
+
+    if (!g_options.additiveClips.empty() && *g_options.additiveClips.rbegin() >= clips.size()) {
+        logln("[Error] --additive 片段不存在: " + std::to_string(*g_options.additiveClips.rbegin()) + " (共 " + std::to_string(clips.size()) + " 个输出片段)");
+        return 1;
+    }
+
     std::map<std::string, unsigned> tempBoneMap;
     unsigned tempBoneCounter = 0;
     for (unsigned i = 0; i < scene->mNumMeshes; ++i) {
@@ -125,75 +1416,725 @@ int main(int argc, char* argv[]) {
     }
 
     std::map<std::string, unsigned> finalBoneMap;
-    processSkeleton(scene, outDir, tempBoneMap, finalBoneMap);
+    std::vector<SkeletonBone> skeleton;
+    std::vector<std::string> written;   // 本次写出的文件 (相对 outDir), --compress 只压缩这些
+    written.push_back(processSkeleton(scene, outDir, tempBoneMap, finalBoneMap, skeleton));
 
-    for (unsigned i = 0; i < scene->mNumMeshes; ++i)
-        processMesh(i, scene->mMeshes[i], outDir, finalBoneMap);
+    TextureTable textures;
+    std::vector<unsigned> materialRemap;
+    std::vector<MaterialEntry> materials = collectMaterials(scene, textures, materialRemap);
 
-    for (unsigned i = 0; i < scene->mNumMaterials; ++i)
-        processMaterial(i, scene->mMaterials[i], scene, outDir);
+    MeshOutputs meshOutputs = processMeshes(scene, outDir, finalBoneMap, skeleton, materialRemap);
+    const std::vector<json>& meshEntries = meshOutputs.entries;
+    for (const json& m : meshEntries) written.push_back(m["file"].get<std::string>());
+    written.push_back(processNodes(scene, outDir, meshOutputs.sources));
+    if (g_options.bakeTransforms || g_options.instanceGeometry) written.push_back(processInstances(outDir, meshOutputs.instances));
+
+    std::vector<std::string> textureFiles = ProcessTextures(textures, scene, outDir, abs.parent_path().string());
+    written.insert(written.end(), textureFiles.begin(), textureFiles.end());
+    written.push_back(writeMaterialTable(materials, textures, outDir));
+
+    std::map<std::string, BonePose> additiveRef;
+    if (g_options.additiveAll || !g_options.additiveClips.empty()) {
+        if (g_options.additiveRefClip < 0) additiveRef = BindReferencePose(skeleton);
+        else {
+            AnimClip refClip = LoadClip(g_options.additiveRefClip, scene->mAnimations[g_options.additiveRefClip]);
+            additiveRef = ClipReferencePose(refClip, g_options.additiveRefFrame, g_options.sampleRate);
+        }
+    }
 
-    for (unsigned i = 0; i < scene->mNumAnimations; ++i)
-        processAnimation(i, scene->mAnimations[i], outDir);
+    const aiMatrix4x4 rootMotionParent = g_options.rootMotionBone.empty() ? aiMatrix4x4() : RestParentTransform(scene, g_options.rootMotionBone);
+    for (unsigned i = 0; i < clips.size(); ++i) {
+        bool additive = g_options.additiveAll || g_options.additiveClips.count(i);
+        std::vector<std::string> animFiles = processAnimation(i, std::move(clips[i]), outDir, additive ? &additiveRef : nullptr, skeleton, g_options.bakeVertexMesh >= 0 ? &meshOutputs.bake : nullptr, rootMotionParent);
+        written.insert(written.end(), animFiles.begin(), animFiles.end());
+    }
 
-    createSceneFile(scene, outDir);
+    if (g_options.benchmark) {
+        RunLoadBenchmark(outDir, (unsigned)meshEntries.size());
+        RunIndexCodecBenchmark(outDir, (unsigned)meshEntries.size());
+        RunVertexCodecBenchmark(outDir, (unsigned)meshEntries.size());
+    }
+    json compression;
+    if (g_options.compressCodec != "none") compression = CompressArtifacts(outDir, written);
+    createSceneFile(outDir, meshEntries, materials.size(), (unsigned)clips.size(), compression);
 
     logln("模型已成功拆分到目录: " + outDir);
     return 0;
 }
 
-void processMesh(unsigned idx, const aiMesh* mesh, const std::string& outDir, const std::map<std::string, unsigned>& finalBoneMap) {
-    std::vector<Vertex> vertices(mesh->mNumVertices);
-    for (unsigned i = 0; i < mesh->mNumVertices; ++i) {
-        vertices[i].position[0] = mesh->mVertices[i].x * G_SCALE_FACTOR;
-        vertices[i].position[1] = mesh->mVertices[i].y * G_SCALE_FACTOR;
-        vertices[i].position[2] = mesh->mVertices[i].z * G_SCALE_FACTOR;
-        if (mesh->HasTextureCoords(0)) {
-            vertices[i].texcoord[0] = mesh->mTextureCoords[0][i].x;
-            vertices[i].texcoord[1] = mesh->mTextureCoords[0][i].y;
+// 按最终输出的顶点字节去重: 缩放, 权重截断/归一化之后才相同的顶点, Assimp 的 JoinIdenticalVertices 合并不到.
+// 开放寻址 (线性探测) 哈希表存首次出现的顶点下标, 逐字节比较, 保持顶点首次出现的顺序.
+static inline uint64_t HashBytes(const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ size;
+    for (; size >= 8; p += 8, size -= 8) {
+        uint64_t k;
+        std::memcpy(&k, p, 8);
+        h = (h ^ (k * 0xBF58476D1CE4E5B9ull)) * 0x94D049BB133111EBull;
+        h ^= h >> 31;
+    }
+    for (; size > 0; ++p, --size) h = (h ^ *p) * 0x100000001B3ull;
+    return h ^ (h >> 29);
+}
+
+template <typename V>
+static void DedupVertices(std::vector<V>& vertices, std::vector<uint32_t>& indices) {
+    const uint32_t EMPTY = 0xFFFFFFFFu;
+    size_t capacity = 16;
+    while (capacity < vertices.size() * 2) capacity <<= 1;
+    std::vector<uint32_t> table(capacity, EMPTY);
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<V> unique;
+    unique.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        size_t slot = HashBytes(&vertices[i], sizeof(V)) & (capacity - 1);
+        while (table[slot] != EMPTY && std::memcmp(&unique[table[slot]], &vertices[i], sizeof(V)) != 0) slot = (slot + 1) & (capacity - 1);
+        if (table[slot] == EMPTY) {
+            table[slot] = (uint32_t)unique.size();
+            unique.push_back(vertices[i]);
         }
-        if (mesh->HasNormals()) {
-            vertices[i].normal[0] = mesh->mNormals[i].x;
-            vertices[i].normal[1] = mesh->mNormals[i].y;
-            vertices[i].normal[2] = mesh->mNormals[i].z;
+        remap[i] = table[slot];
+    }
+    for (uint32_t& idx : indices) idx = remap[idx];
+    vertices.swap(unique);
+}
+
+// 贪心切分: 三角形依次放入第一个放得下的批次 (批次引用的骨骼数 <= limit), 否则新开一批;
+// 然后按批次重排顶点 (跨批次共享的顶点会复制) 并把 boneIDs 改为批次调色板内的下标.
+template <typename V>
+static bool PartitionBonePalette(std::vector<V>& vertices, std::vector<uint32_t>& indices, unsigned limit,
+                                 std::vector<MeshBatch>& batches, std::vector<uint32_t>& palette) {
+    constexpr size_t K = std::extent<decltype(V::boneIDs)>::value;
+    auto triBones = [&](size_t t, std::vector<int>& out) {
+        out.clear();
+        for (size_t c = 0; c < 3; ++c) {
+            const V& v = vertices[indices[t * 3 + c]];
+            for (size_t k = 0; k < K; ++k) if (v.boneIDs[k] >= 0 && v.weights[k] > 0.0f) out.push_back(v.boneIDs[k]);
         }
-        if (mesh->HasTangentsAndBitangents()) {
-            vertices[i].tangent[0] = mesh->mTangents[i].x;
-            vertices[i].tangent[1] = mesh->mTangents[i].y;
-            vertices[i].tangent[2] = mesh->mTangents[i].z;
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    };
+    struct Work { std::set<int> bones; std::vector<uint32_t> tris; };
+    std::vector<Work> work;
+    std::vector<int> bones;
+    size_t triCount = indices.size() / 3;
+    for (size_t t = 0; t < triCount; ++t) {
+        triBones(t, bones);
+        if (bones.size() > limit) return false;
+        Work* target = nullptr;
+        for (auto& w : work) {
+            size_t added = 0;
+            for (int b : bones) added += w.bones.count(b) ? 0 : 1;
+            if (w.bones.size() + added <= limit) { target = &w; break; }
         }
+        if (!target) { work.emplace_back(); target = &work.back(); }
+        target->bones.insert(bones.begin(), bones.end());
+        target->tris.push_back((uint32_t)t);
     }
-    for (unsigned bi = 0; bi < mesh->mNumBones; ++bi) {
-        aiBone* b = mesh->mBones[bi];
-        auto it = finalBoneMap.find(b->mName.C_Str());
-        if (it != finalBoneMap.end()) {
-            unsigned finalId = it->second;
-            for (unsigned wi = 0; wi < b->mNumWeights; ++wi) {
-                AddBoneWeight(vertices[b->mWeights[wi].mVertexId], (int)finalId, b->mWeights[wi].mWeight);
+    std::vector<V> outVertices;
+    std::vector<uint32_t> outIndices;
+    outVertices.reserve(vertices.size());
+    outIndices.reserve(indices.size());
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<uint32_t> stamp(vertices.size(), UINT32_MAX);
+    for (uint32_t bi = 0; bi < (uint32_t)work.size(); ++bi) {
+        const Work& w = work[bi];
+        MeshBatch batch{};
+        batch.indexOffset = (uint32_t)outIndices.size();
+        batch.vertexOffset = (uint32_t)outVertices.size();
+        batch.paletteOffset = (uint32_t)palette.size();
+        std::map<int, int> local;
+        for (int b : w.bones) { local[b] = (int)(palette.size() - batch.paletteOffset); palette.push_back((uint32_t)b); }
+        for (uint32_t t : w.tris) {
+            for (size_t c = 0; c < 3; ++c) {
+                uint32_t vi = indices[t * 3 + c];
+                if (stamp[vi] != bi) {
+                    stamp[vi] = bi;
+                    remap[vi] = (uint32_t)outVertices.size();
+                    V v = vertices[vi];
+                    for (size_t k = 0; k < K; ++k) {
+                        auto it = (v.boneIDs[k] >= 0 && v.weights[k] > 0.0f) ? local.find(v.boneIDs[k]) : local.end();
+                        if (it != local.end()) v.boneIDs[k] = it->second;
+                        else { v.boneIDs[k] = -1; v.weights[k] = 0.0f; }
+                    }
+                    outVertices.push_back(v);
+                }
+                outIndices.push_back(remap[vi]);
             }
         }
+        batch.indexCount = (uint32_t)outIndices.size() - batch.indexOffset;
+        batch.vertexCount = (uint32_t)outVertices.size() - batch.vertexOffset;
+        batch.paletteCount = (uint32_t)palette.size() - batch.paletteOffset;
+        batches.push_back(batch);
     }
-    for (auto& v : vertices) NormalizeWeights(v);
+    vertices.swap(outVertices);
+    indices.swap(outIndices);
+    return true;
+}
+
+struct MeshBounds {
+    float min[3]{};
+    float max[3]{};
+    float center[3]{};
+    float radius{};
+};
+
+// 位置在每个顶点的开头: 每次加载 4 个 float (第 4 个是 texcoord[0], 结果中忽略)
+template <typename V>
+static MeshBounds ComputeBounds(const std::vector<V>& vertices) {
+    MeshBounds b;
+    if (vertices.empty()) return b;
+#ifdef MC_X86
+    __m128 mn = _mm_loadu_ps(vertices[0].position), mx = mn;
+    for (const V& v : vertices) { __m128 p = _mm_loadu_ps(v.position); mn = _mm_min_ps(mn, p); mx = _mm_max_ps(mx, p); }
+    alignas(16) float fmn[4], fmx[4];
+    _mm_store_ps(fmn, mn); _mm_store_ps(fmx, mx);
+    for (int k = 0; k < 3; ++k) { b.min[k] = fmn[k]; b.max[k] = fmx[k]; b.center[k] = 0.5f * (fmn[k] + fmx[k]); }
+    const __m128 c = _mm_setr_ps(b.center[0], b.center[1], b.center[2], 0.0f);
+    const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    __m128 r2 = _mm_setzero_ps();
+    for (const V& v : vertices) {
+        __m128 d = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(v.position), c), mask);
+        d = _mm_mul_ps(d, d);
+        d = _mm_add_ps(d, _mm_movehl_ps(d, d));
+        d = _mm_add_ss(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1)));
+        r2 = _mm_max_ss(r2, d);
+    }
+    b.radius = std::sqrt(_mm_cvtss_f32(r2));
+#else
+    for (int k = 0; k < 3; ++k) b.min[k] = b.max[k] = vertices[0].position[k];
+    for (const V& v : vertices) for (int k = 0; k < 3; ++k) { b.min[k] = std::min(b.min[k], v.position[k]); b.max[k] = std::max(b.max[k], v.position[k]); }
+    for (int k = 0; k < 3; ++k) b.center[k] = 0.5f * (b.min[k] + b.max[k]);
+    float r2 = 0.0f;
+    for (const V& v : vertices) {
+        float dx = v.position[0] - b.center[0], dy = v.position[1] - b.center[1], dz = v.position[2] - b.center[2];
+        r2 = std::max(r2, dx * dx + dy * dy + dz * dz);
+    }
+    b.radius = std::sqrt(r2);
+#endif
+    return b;
+}
+
+template <typename V>
+static std::vector<BoneBounds> ComputeBoneBounds(const std::vector<V>& vertices, const std::vector<SkeletonBone>& skeleton) {
+    constexpr size_t K = std::extent<decltype(V::boneIDs)>::value;
+    std::vector<BoneBounds> bounds(skeleton.size());
+    std::vector<bool> used(skeleton.size(), false);
+    for (const V& v : vertices) {
+        aiVector3D p(v.position[0], v.position[1], v.position[2]);
+        for (size_t k = 0; k < K; ++k) {
+            int b = v.boneIDs[k];
+            if (b < 0 || (size_t)b >= skeleton.size() || v.weights[k] <= 0.0f) continue;
+            aiVector3D q = skeleton[b].offset * p;
+            BoneBounds& bb = bounds[b];
+            if (!used[b]) { used[b] = true; bb.boneId = (uint32_t)b; bb.min[0] = bb.max[0] = q.x; bb.min[1] = bb.max[1] = q.y; bb.min[2] = bb.max[2] = q.z; continue; }
+            bb.min[0] = std::min(bb.min[0], q.x); bb.min[1] = std::min(bb.min[1], q.y); bb.min[2] = std::min(bb.min[2], q.z);
+            bb.max[0] = std::max(bb.max[0], q.x); bb.max[1] = std::max(bb.max[1], q.y); bb.max[2] = std::max(bb.max[2], q.z);
+        }
+    }
+    std::vector<BoneBounds> out;
+    for (size_t b = 0; b < bounds.size(); ++b) if (used[b]) out.push_back(bounds[b]);
+    return out;
+}
+
+static inline json Vec3ToJson(const float* v) { return json::array({ v[0], v[1], v[2] }); }
+
+static inline void PadTo(std::ofstream& out, uint32_t alignment) {
+    static const char zeros[64]{};
+    uint64_t pos = (uint64_t)out.tellp();
+    uint64_t pad = (alignment - pos % alignment) % alignment;
+    out.write(zeros, (std::streamsize)pad);
+}
+
+struct MeshSectionData {
+    MeshSection desc{};
+    std::vector<char> bytes;
+};
+
+template <typename T>
+static MeshSectionData MakeSection(uint32_t type, const std::vector<T>& items) {
+    MeshSectionData sec;
+    sec.desc.type = type;
+    sec.desc.encoding = ENCODING_RAW;
+    sec.desc.elementCount = (uint32_t)items.size();
+    sec.desc.stride = (uint32_t)sizeof(T);
+    sec.bytes.resize(items.size() * sizeof(T));
+    if (!items.empty()) std::memcpy(sec.bytes.data(), items.data(), sec.bytes.size());
+    return sec;
+}
+
+// 交错布局: 一个 VERTEX section, stride = sizeof(V).
+// 拆分布局: 位置 (12B) / 着色属性 (32B) / 蒙皮 (仅蒙皮网格) 各一个 section, 深度/阴影 pass 只需读取位置流.
+template <typename V>
+static void BuildVertexSections(const std::vector<V>& vertices, bool split, bool skinned,
+                                std::vector<MeshSectionData>& sections, std::vector<VertexAttribute>& attributes) {
+    constexpr uint8_t K = (uint8_t)std::extent<decltype(V::boneIDs)>::value;
+    if (!split) {
+        uint32_t sec = (uint32_t)sections.size(), stride = (uint32_t)sizeof(V);
+        sections.push_back(MakeSection(SECTION_VERTEX, vertices));
+        attributes.push_back({ ATTR_POSITION, COMPONENT_FLOAT32, 3, sec, (uint32_t)offsetof(V, position), stride });
+        attributes.push_back({ ATTR_TEXCOORD0, COMPONENT_FLOAT32, 2, sec, (uint32_t)offsetof(V, texcoord), stride });
+        attributes.push_back({ ATTR_NORMAL, COMPONENT_FLOAT32, 3, sec, (uint32_t)offsetof(V, normal), stride });
+        attributes.push_back({ ATTR_TANGENT, COMPONENT_FLOAT32, 3, sec, (uint32_t)offsetof(V, tangent), stride });
+        attributes.push_back({ ATTR_BONE_INDICES, COMPONENT_SINT32, K, sec, (uint32_t)offsetof(V, boneIDs), stride });
+        attributes.push_back({ ATTR_BONE_WEIGHTS, COMPONENT_FLOAT32, K, sec, (uint32_t)offsetof(V, weights), stride });
+        return;
+    }
+    auto stream = [&](uint32_t stride, auto fill) {
+        MeshSectionData sec;
+        sec.desc.type = SECTION_VERTEX;
+        sec.desc.encoding = ENCODING_RAW;
+        sec.desc.elementCount = (uint32_t)vertices.size();
+        sec.desc.stride = stride;
+        sec.bytes.resize(vertices.size() * stride);
+        char* dst = sec.bytes.data();
+        for (const V& v : vertices) { fill(v, dst); dst += stride; }
+        sections.push_back(std::move(sec));
+        return (uint32_t)sections.size() - 1;
+    };
+    uint32_t pos = stream(12, [](const V& v, char* d) { std::memcpy(d, v.position, 12); });
+    attributes.push_back({ ATTR_POSITION, COMPONENT_FLOAT32, 3, pos, 0, 12 });
+    uint32_t shading = stream(32, [](const V& v, char* d) { std::memcpy(d, v.texcoord, 32); });
+    attributes.push_back({ ATTR_TEXCOORD0, COMPONENT_FLOAT32, 2, shading, 0, 32 });
+    attributes.push_back({ ATTR_NORMAL, COMPONENT_FLOAT32, 3, shading, 8, 32 });
+    attributes.push_back({ ATTR_TANGENT, COMPONENT_FLOAT32, 3, shading, 20, 32 });
+    if (skinned) {
+        uint32_t skin = stream(K * 8u, [](const V& v, char* d) { std::memcpy(d, v.boneIDs, K * 4); std::memcpy(d + K * 4, v.weights, K * 4); });
+        attributes.push_back({ ATTR_BONE_INDICES, COMPONENT_SINT32, K, skin, 0, K * 8u });
+        attributes.push_back({ ATTR_BONE_WEIGHTS, COMPONENT_FLOAT32, K, skin, K * 4u, K * 8u });
+    }
+}
+
+static void WriteMeshFile(const std::string& path, MeshFileHeader header, const std::vector<VertexAttribute>& attributes, std::vector<MeshSectionData>& sections) {
+    auto align = [](uint64_t v) { return (v + MESH_SECTION_ALIGNMENT - 1) / MESH_SECTION_ALIGNMENT * MESH_SECTION_ALIGNMENT; };
+    header.magic = MESH_MAGIC;
+    header.version = MESH_VERSION;
+    header.headerSize = (uint16_t)sizeof(MeshFileHeader);
+    header.attributeCount = (uint32_t)attributes.size();
+    header.attributeOffset = (uint32_t)sizeof(MeshFileHeader);
+    header.sectionCount = (uint32_t)sections.size();
+    header.sectionOffset = header.attributeOffset + header.attributeCount * (uint32_t)sizeof(VertexAttribute);
+    uint64_t cursor = header.sectionOffset + header.sectionCount * sizeof(MeshSection);
+    for (auto& sec : sections) {
+        cursor = align(cursor);
+        sec.desc.offset = (uint32_t)cursor;
+        sec.desc.size = (uint32_t)sec.bytes.size();
+        cursor += sec.bytes.size();
+    }
+    std::ofstream out(path, std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)attributes.data(), attributes.size() * sizeof(VertexAttribute));
+    for (const auto& sec : sections) out.write((const char*)&sec.desc, sizeof(MeshSection));
+    for (const auto& sec : sections) {
+        PadTo(out, MESH_SECTION_ALIGNMENT);
+        out.write(sec.bytes.data(), (std::streamsize)sec.bytes.size());
+    }
+}
+
+// 转换后的网格, 写文件前可以再合并
+template <typename V>
+struct MeshData {
+    std::vector<V> vertices;
     std::vector<uint32_t> indices;
+    std::vector<MeshBatch> batches;
+    std::vector<uint32_t> palette;
+    std::vector<BoneBounds> boneBounds;
+    std::vector<SubMesh> submeshes;   // 合并后各源网格的范围, 未合并为空
+    MeshBounds bounds;
+    unsigned materialIndex = 0;
+    bool skinned = false;
+    bool triangles = true;            // SortByPType 拆出的线 / 点网格为 false
+};
+
+template <typename V>
+static MeshData<V> BuildMesh(unsigned idx, const aiMesh* mesh, const std::map<std::string, unsigned>& finalBoneMap, const std::vector<SkeletonBone>& skeleton) {
+    constexpr uint32_t influenceCount = (uint32_t)std::extent<decltype(V::boneIDs)>::value;
+    MeshData<V> data;
+    data.materialIndex = mesh->mMaterialIndex;
+    data.skinned = mesh->HasBones();
+    data.triangles = mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE;
+    std::vector<V>& vertices = data.vertices;
+    std::vector<uint32_t>& indices = data.indices;
+    WeightStats weightStats;
+    vertices = BuildVertices<V>(mesh, finalBoneMap, &weightStats);
+    if (weightStats.truncatedVertices > 0) {
+        std::ostringstream ss;
+        ss << "[Warn] mesh_" << idx << ": " << weightStats.truncatedVertices << " 个顶点的骨骼影响超过 " << influenceCount
+           << " 个, 已截断 (最大丢失权重 " << weightStats.maxLostWeight * 100.0f << "%)";
+        logln(ss.str());
+    }
     indices.reserve(mesh->mNumFaces * 3);
     for (unsigned f = 0; f < mesh->mNumFaces; ++f) {
         for (unsigned j = 0; j < mesh->mFaces[f].mNumIndices; ++j) indices.push_back(mesh->mFaces[f].mIndices[j]);
     }
-    std::string path = outDir + "/mesh_" + std::to_string(idx) + ".mesh";
+    if (g_options.dedup) {
+        size_t sourceVertices = vertices.size();
+        DedupVertices(vertices, indices);
+        if (vertices.size() < sourceVertices) {
+            std::ostringstream ss;
+            ss << "[Info] mesh_" << idx << ": 顶点去重 " << sourceVertices << " -> " << vertices.size()
+               << " (-" << (sourceVertices - vertices.size()) * 100.0 / sourceVertices << "%)";
+            logln(ss.str());
+        }
+    }
+    data.bounds = ComputeBounds(vertices);
+    if (data.skinned) data.boneBounds = ComputeBoneBounds(vertices, skeleton);
+    // 切分按三角形进行; SortByPType 拆出的线 / 点网格不切分
+    if (g_options.bonePalette > 0 && data.skinned && !data.triangles)
+        logln("[Warn] mesh_" + std::to_string(idx) + ": 非三角形网格, 未按 --bone-palette 切分");
+    else if (g_options.bonePalette > 0 && data.skinned) {
+        size_t sourceVertices = vertices.size();
+        if (PartitionBonePalette(vertices, indices, g_options.bonePalette, data.batches, data.palette)) {
+            std::ostringstream ss;
+            ss << "[Info] mesh_" << idx << ": " << data.batches.size() << " 个调色板批次 (每批 <= " << g_options.bonePalette << " 根骨骼), 顶点 " << sourceVertices << " -> " << vertices.size();
+            logln(ss.str());
+        }
+        else logln("[Warn] mesh_" + std::to_string(idx) + ": 单个三角形引用的骨骼数超过 --bone-palette, 未切分");
+    }
+    return data;
+}
+
+// 输出网格的最终顶点转成烘焙顶点; 切分过调色板的网格把批次内下标换回骨骼 ID
+template <typename V>
+static std::vector<BakeVertex> MakeBakeVertices(const MeshData<V>& data) {
+    constexpr size_t K = std::extent<decltype(V::boneIDs)>::value;
+    std::vector<BakeVertex> vertices(data.vertices.size());
+    for (size_t i = 0; i < data.vertices.size(); ++i) {
+        const V& src = data.vertices[i];
+        std::copy(src.position, src.position + 3, vertices[i].position);
+        std::copy(src.boneIDs, src.boneIDs + K, vertices[i].boneIDs);
+        std::copy(src.weights, src.weights + K, vertices[i].weights);
+    }
+    for (const MeshBatch& batch : data.batches) {
+        for (uint32_t i = batch.vertexOffset; i < batch.vertexOffset + batch.vertexCount; ++i)
+            for (size_t k = 0; k < K; ++k)
+                if (vertices[i].boneIDs[k] >= 0) vertices[i].boneIDs[k] = (int)data.palette[batch.paletteOffset + vertices[i].boneIDs[k]];
+    }
+    return vertices;
+}
+
+// 把同材质的静态网格依次拼接进一个顶点/索引缓冲, 索引加上顶点偏移, 并记录每个源网格的范围.
+// 同一次转换的顶点布局都是 VertexT<N>, 因此只需材质相同且无蒙皮即可合并.
+template <typename V>
+static MeshData<V> MergeMeshes(std::vector<MeshData<V>>& meshes, const std::vector<unsigned>& members) {
+    MeshData<V> merged;
+    merged.materialIndex = meshes[members[0]].materialIndex;
+    for (unsigned m : members) {
+        MeshData<V>& src = meshes[m];
+        SubMesh sub;
+        sub.sourceMesh = m;
+        sub.indexOffset = (uint32_t)merged.indices.size();
+        sub.indexCount = (uint32_t)src.indices.size();
+        sub.vertexOffset = (uint32_t)merged.vertices.size();
+        sub.vertexCount = (uint32_t)src.vertices.size();
+        merged.submeshes.push_back(sub);
+        merged.vertices.insert(merged.vertices.end(), src.vertices.begin(), src.vertices.end());
+        for (uint32_t idx : src.indices) merged.indices.push_back(idx + sub.vertexOffset);
+        src = MeshData<V>();
+    }
+    merged.bounds = ComputeBounds(merged.vertices);
+    return merged;
+}
+
+template <typename V>
+static json WriteMesh(unsigned idx, const MeshData<V>& data, const std::string& outDir) {
+    constexpr uint32_t influenceCount = (uint32_t)std::extent<decltype(V::boneIDs)>::value;
+    const MeshBounds& bounds = data.bounds;
+    MeshFileHeader header{};
+    header.flags = g_options.splitStreams ? MESH_FLAG_SPLIT_STREAMS : 0u;
+    header.vertexCount = (uint32_t)data.vertices.size();
+    header.indexCount = (uint32_t)data.indices.size();
+    header.materialIndex = data.materialIndex;
+    header.influenceCount = influenceCount;
+    std::copy(bounds.min, bounds.min + 3, header.aabbMin);
+    std::copy(bounds.max, bounds.max + 3, header.aabbMax);
+    std::copy(bounds.center, bounds.center + 3, header.sphereCenter);
+    header.sphereRadius = bounds.radius;
+    std::vector<MeshSectionData> sections;
+    std::vector<VertexAttribute> attributes;
+    BuildVertexSections(data.vertices, g_options.splitStreams, data.skinned, sections, attributes);
+    if (g_options.compressVertices) {
+        for (MeshSectionData& sec : sections) {
+            std::vector<unsigned char> encoded = EncodeVertices((const unsigned char*)sec.bytes.data(), sec.desc.elementCount, sec.desc.stride);
+            sec.desc.encoding = ENCODING_VERTEX_BYTEPLANE;
+            sec.bytes.assign(encoded.begin(), encoded.end());
+        }
+    }
+    sections.push_back(MakeSection(SECTION_INDEX, data.indices));
+    if (g_options.compressIndices) {
+        MeshSectionData& sec = sections.back();
+        std::vector<unsigned char> encoded = EncodeIndices(data.indices.data(), data.indices.size());
+        sec.desc.encoding = ENCODING_INDEX_DELTA_VBYTE;
+        sec.bytes.assign(encoded.begin(), encoded.end());
+    }
+    if (!data.batches.empty()) {
+        sections.push_back(MakeSection(SECTION_BATCHES, data.batches));
+        sections.push_back(MakeSection(SECTION_PALETTE, data.palette));
+    }
+    if (!data.boneBounds.empty()) sections.push_back(MakeSection(SECTION_BONE_BOUNDS, data.boneBounds));
+    if (!data.submeshes.empty()) sections.push_back(MakeSection(SECTION_SUBMESHES, data.submeshes));
+    WriteMeshFile(outDir + "/mesh_" + std::to_string(idx) + ".mesh", header, attributes, sections);
+    json m;
+    m["file"] = "mesh_" + std::to_string(idx) + ".mesh";
+    m["materialIndex"] = data.materialIndex;
+    m["bounds"] = { {"min", Vec3ToJson(bounds.min)}, {"max", Vec3ToJson(bounds.max)}, {"center", Vec3ToJson(bounds.center)}, {"radius", bounds.radius} };
+    if (!data.boneBounds.empty()) {
+        m["boneBounds"] = json::array();
+        for (const auto& bb : data.boneBounds) m["boneBounds"].push_back({ {"bone", bb.boneId}, {"min", Vec3ToJson(bb.min)}, {"max", Vec3ToJson(bb.max)} });
+    }
+    if (!data.submeshes.empty()) {
+        m["submeshes"] = json::array();
+        for (const auto& sub : data.submeshes)
+            m["submeshes"].push_back({ {"source", sub.sourceMesh}, {"indexOffset", sub.indexOffset}, {"indexCount", sub.indexCount},
+                                       {"vertexOffset", sub.vertexOffset}, {"vertexCount", sub.vertexCount} });
+    }
+    return m;
+}
+
+// 把节点世界变换烘焙进顶点: 位置乘完整矩阵, 法线乘逆转置, 切线乘 3x3; 镜像变换时翻转三角形绕序 (线 / 点网格没有绕序)
+template <typename V>
+static void BakeTransform(MeshData<V>& data, const aiMatrix4x4& world) {
+    aiMatrix4x4 linear = world;
+    linear.a4 = linear.b4 = linear.c4 = 0.0f;
+    aiMatrix4x4 inverse = aiMatrix4x4(linear).Inverse();
+    auto normalize = [](float v[3]) {
+        float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (len > 1e-12f) for (int c = 0; c < 3; ++c) v[c] /= len;
+    };
+    for (V& v : data.vertices) {
+        float p[3], n[3], t[3];
+        for (int r = 0; r < 3; ++r) {
+            p[r] = world[r][0] * v.position[0] + world[r][1] * v.position[1] + world[r][2] * v.position[2] + world[r][3];
+            n[r] = inverse[0][r] * v.normal[0] + inverse[1][r] * v.normal[1] + inverse[2][r] * v.normal[2];
+            t[r] = world[r][0] * v.tangent[0] + world[r][1] * v.tangent[1] + world[r][2] * v.tangent[2];
+        }
+        normalize(n);
+        normalize(t);
+        std::copy(p, p + 3, v.position);
+        std::copy(n, n + 3, v.normal);
+        std::copy(t, t + 3, v.tangent);
+    }
+    if (linear.Determinant() < 0.0f && data.triangles)
+        for (size_t i = 0; i + 2 < data.indices.size(); i += 3) std::swap(data.indices[i + 1], data.indices[i + 2]);
+    data.bounds = ComputeBounds(data.vertices);
+}
+
+static void StoreMatrix3x4(const aiMatrix4x4& m, float out[12]) {
+    for (int k = 0; k < 12; ++k) out[k] = m[k / 4][k % 4];
+}
+
+template <typename V>
+static bool SameGeometry(const MeshData<V>& a, const MeshData<V>& b) {
+    return a.materialIndex == b.materialIndex && a.triangles == b.triangles && a.vertices.size() == b.vertices.size() && a.indices.size() == b.indices.size() &&
+           std::memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(V)) == 0 &&
+           std::memcmp(a.indices.data(), b.indices.data(), a.indices.size() * sizeof(uint32_t)) == 0;
+}
+
+// 按最终顶点 / 索引字节与材质找出完全相同的静态网格, canonical[i] 为与 i 相同的第一个网格; 返回重复数
+template <typename V>
+static unsigned FindDuplicateGeometry(const std::vector<MeshData<V>>& meshes, std::vector<unsigned>& canonical) {
+    std::unordered_map<uint64_t, std::vector<unsigned>> byHash;
+    unsigned duplicates = 0;
+    for (unsigned i = 0; i < meshes.size(); ++i) {
+        const MeshData<V>& m = meshes[i];
+        canonical[i] = i;
+        if (m.skinned) continue;
+        uint64_t h = HashBytes(m.vertices.data(), m.vertices.size() * sizeof(V));
+        h = (h ^ HashBytes(m.indices.data(), m.indices.size() * sizeof(uint32_t))) * 0x94D049BB133111EBull ^ m.materialIndex;
+        std::vector<unsigned>& bucket = byHash[h];
+        for (unsigned j : bucket)
+            if (SameGeometry(meshes[j], m)) { canonical[i] = j; ++duplicates; break; }
+        if (canonical[i] == i) bucket.push_back(i);
+    }
+    return duplicates;
+}
+
+template <typename V>
+static MeshOutputs ConvertMeshes(const aiScene* scene, const std::string& outDir, const std::map<std::string, unsigned>& finalBoneMap, const std::vector<SkeletonBone>& skeleton, const std::vector<unsigned>& materialRemap) {
+    std::vector<MeshData<V>> meshes;
+    for (unsigned i = 0; i < scene->mNumMeshes; ++i) {
+        meshes.push_back(BuildMesh<V>(i, scene->mMeshes[i], finalBoneMap, skeleton));
+        if (meshes.back().materialIndex < materialRemap.size()) meshes.back().materialIndex = materialRemap[meshes.back().materialIndex];
+    }
+
+    // --instance-geometry: 相同几何只保留第一份, 其余网格的节点引用都指向它
+    std::vector<unsigned> canonical(meshes.size());
+    for (unsigned i = 0; i < meshes.size(); ++i) canonical[i] = i;
+    if (g_options.instanceGeometry) {
+        unsigned duplicates = FindDuplicateGeometry(meshes, canonical);
+        if (duplicates > 0)
+            logln("[Info] 几何实例化: " + std::to_string(meshes.size()) + " 个网格 -> " + std::to_string(meshes.size() - duplicates) + " 份几何");
+    }
+
+    // 静态网格改由实例绘制: --bake-transforms 时只被一个节点引用的网格烘焙到世界空间,
+    // 其余被节点引用的网格保持局部空间, 每个引用节点输出一个实例
+    const bool instancing = g_options.bakeTransforms || g_options.instanceGeometry;
+    std::vector<FlatNode> flat;
+    std::vector<std::vector<unsigned>> nodeRefs(meshes.size());
+    std::vector<bool> baked(meshes.size(), false);
+    if (instancing || g_options.mergeByMaterial) {
+        FlattenNodes(scene->mRootNode, -1, flat);
+        for (unsigned n = 0; n < flat.size(); ++n)
+            for (unsigned k = 0; k < flat[n].node->mNumMeshes; ++k)
+                if (flat[n].node->mMeshes[k] < meshes.size()) nodeRefs[canonical[flat[n].node->mMeshes[k]]].push_back(n);
+    }
+    if (g_options.bakeTransforms) {
+        unsigned bakedCount = 0, instancedCount = 0;
+        for (unsigned i = 0; i < meshes.size(); ++i) {
+            if (meshes[i].skinned) continue;
+            if (nodeRefs[i].size() == 1) { BakeTransform(meshes[i], flat[nodeRefs[i][0]].world); baked[i] = true; ++bakedCount; }
+            else if (nodeRefs[i].size() > 1) ++instancedCount;
+        }
+        logln("[Info] 烘焙变换: " + std::to_string(bakedCount) + " 个静态网格烘焙到世界空间, " + std::to_string(instancedCount) + " 个网格按实例输出");
+    }
+
+    // 输出顺序: 按源网格顺序, 合并组出现在其第一个成员的位置; 重复几何不输出.
+    // 合并后的网格只能共用一个变换: 已烘焙的网格都在世界空间, 按材质分组; 未使用实例时只合并只被一个节点引用的网格,
+    // 按 材质 + 节点世界变换 分组; 其余网格 (被多个节点引用 / 未被引用 / 按实例输出) 与线 / 点网格不合并
+    std::vector<std::vector<unsigned>> outputs;
+    std::map<std::pair<unsigned, std::array<ai_real, 16>>, size_t> groupOf;
+    unsigned unmerged = 0;
+    for (unsigned i = 0; i < meshes.size(); ++i) {
+        if (canonical[i] != i) continue;
+        if (!g_options.mergeByMaterial || meshes[i].skinned || !meshes[i].triangles) { outputs.push_back({ i }); continue; }
+        if (!baked[i] && (instancing || nodeRefs[i].size() != 1)) { outputs.push_back({ i }); ++unmerged; continue; }
+        const aiMatrix4x4 world = baked[i] ? aiMatrix4x4() : flat[nodeRefs[i][0]].world;
+        std::pair<unsigned, std::array<ai_real, 16>> key = { meshes[i].materialIndex, {} };
+        std::memcpy(key.second.data(), &world.a1, sizeof(key.second));
+        auto it = groupOf.find(key);
+        if (it == groupOf.end()) { groupOf[key] = outputs.size(); outputs.push_back({ i }); }
+        else outputs[it->second].push_back(i);
+    }
+    if (unmerged > 0)
+        logln("[Info] 按材质合并: " + std::to_string(unmerged) + " 个静态网格因被多个节点引用或未被节点引用而未参与合并");
+
+    MeshOutputs result;
+    std::vector<json>& entries = result.entries;
+    result.sources.resize(meshes.size());
+    for (const auto& members : outputs) {
+        unsigned idx = (unsigned)entries.size();
+        for (size_t k = 0; k < members.size(); ++k) result.sources[members[k]] = { idx, members.size() == 1 ? NODE_WHOLE_MESH : (uint32_t)k };
+        if (baked[members[0]]) {
+            MeshInstance inst = { idx, NODE_WHOLE_MESH, {} };
+            StoreMatrix3x4(aiMatrix4x4(), inst.world);
+            result.instances.push_back(inst);
+        }
+        else if (instancing && !meshes[members[0]].skinned) {
+            for (unsigned n : nodeRefs[members[0]]) {
+                MeshInstance inst = { idx, NODE_WHOLE_MESH, {} };
+                StoreMatrix3x4(flat[n].world, inst.world);
+                result.instances.push_back(inst);
+            }
+        }
+        const bool bake = g_options.bakeVertexMesh >= 0 && std::find(members.begin(), members.end(), canonical[g_options.bakeVertexMesh]) != members.end();
+        if (bake) result.bake.mesh = idx;
+        if (members.size() == 1) {
+            if (bake) result.bake.vertices = MakeBakeVertices(meshes[members[0]]);
+            entries.push_back(WriteMesh(idx, meshes[members[0]], outDir));
+            continue;
+        }
+        MeshData<V> merged = MergeMeshes(meshes, members);
+        if (bake) result.bake.vertices = MakeBakeVertices(merged);
+        std::ostringstream ss;
+        ss << "[Info] mesh_" << idx << ": 合并 " << members.size() << " 个材质 " << merged.materialIndex << " 的静态网格, 顶点 "
+           << merged.vertices.size() << ", 索引 " << merged.indices.size();
+        logln(ss.str());
+        entries.push_back(WriteMesh(idx, merged, outDir));
+    }
+    size_t unique = 0;
+    for (unsigned i = 0; i < meshes.size(); ++i) {
+        result.sources[i] = result.sources[canonical[i]];
+        if (canonical[i] == i) ++unique;
+    }
+    if (entries.size() < unique)
+        logln("[Info] 按材质合并: 网格 " + std::to_string(unique) + " -> " + std::to_string(entries.size()));
+    return result;
+}
+
+MeshOutputs processMeshes(const aiScene* scene, const std::string& outDir, const std::map<std::string, unsigned>& finalBoneMap, const std::vector<SkeletonBone>& skeleton, const std::vector<unsigned>& materialRemap) {
+    switch (g_options.maxInfluences) {
+    case 2:  return ConvertMeshes<VertexT<2>>(scene, outDir, finalBoneMap, skeleton, materialRemap);
+    case 8:  return ConvertMeshes<VertexT<8>>(scene, outDir, finalBoneMap, skeleton, materialRemap);
+    default: return ConvertMeshes<VertexT<4>>(scene, outDir, finalBoneMap, skeleton, materialRemap);
+    }
+}
+
+// skeleton.bin: 父骨骼数组, 3x4 SoA 矩阵 (inverse bind / 局部绑定 / 全局绑定), 名字哈希表与字符串池, 布局见 ModelFormat.h
+static void WriteSkeletonFile(const std::string& path, const std::vector<SkeletonBone>& skeleton) {
+    SkeletonFileHeader header = {};
+    header.magic = SKELETON_MAGIC;
+    header.version = SKELETON_VERSION;
+    header.headerSize = (uint16_t)sizeof(SkeletonFileHeader);
+    header.boneCount = (uint32_t)skeleton.size();
+    header.paddedCount = (header.boneCount + SKELETON_SIMD_WIDTH - 1) / SKELETON_SIMD_WIDTH * SKELETON_SIMD_WIDTH;
+
+    std::vector<int32_t> parents;
+    std::vector<uint32_t> names;
+    std::string pool;
+    for (const SkeletonBone& b : skeleton) {
+        parents.push_back(b.parentId);
+        names.push_back((uint32_t)pool.size());
+        pool.append(b.name).push_back('\0');
+    }
+
+    // SoA, 补齐部分为单位矩阵
+    auto soa = [&](auto matrixOf) {
+        std::vector<float> m(12 * (size_t)header.paddedCount);
+        for (uint32_t i = 0; i < header.paddedCount; ++i) {
+            aiMatrix4x4 x = i < header.boneCount ? matrixOf(skeleton[i]) : aiMatrix4x4();
+            for (int k = 0; k < 12; ++k) m[(size_t)k * header.paddedCount + i] = x[k / 4][k % 4];
+        }
+        return m;
+    };
+    std::vector<float> inverseBind = soa([](const SkeletonBone& b) { return b.offset; });
+    std::vector<float> bindLocal = soa([](const SkeletonBone& b) { return b.bindLocal; });
+    std::vector<float> bindGlobal = soa([](const SkeletonBone& b) { return aiMatrix4x4(b.offset).Inverse(); });
+
+    header.hashCapacity = 0;
+    if (header.boneCount) {
+        header.hashCapacity = 1;
+        while (header.hashCapacity < header.boneCount * 2) header.hashCapacity <<= 1;
+    }
+    std::vector<SkeletonNameSlot> slots(header.hashCapacity, SkeletonNameSlot{ 0, SKELETON_NO_BONE });
+    for (uint32_t i = 0; i < header.boneCount; ++i) {
+        uint32_t h = HashBoneName(skeleton[i].name.c_str());
+        uint32_t s = h & (header.hashCapacity - 1);
+        while (slots[s].bone != SKELETON_NO_BONE) s = (s + 1) & (header.hashCapacity - 1);
+        slots[s] = { h, i };
+    }
+
+    auto align = [](uint64_t v, uint64_t a) { return (v + a - 1) / a * a; };
+    uint64_t cursor = sizeof(SkeletonFileHeader);
+    header.parentOffset = (uint32_t)cursor;
+    cursor += parents.size() * sizeof(int32_t);
+    header.nameOffset = (uint32_t)cursor;
+    cursor += names.size() * sizeof(uint32_t);
+    header.inverseBindOffset = (uint32_t)(cursor = align(cursor, SKELETON_SIMD_ALIGNMENT));
+    cursor += inverseBind.size() * sizeof(float);
+    header.bindLocalOffset = (uint32_t)cursor;
+    cursor += bindLocal.size() * sizeof(float);
+    header.bindGlobalOffset = (uint32_t)cursor;
+    cursor += bindGlobal.size() * sizeof(float);
+    header.hashOffset = (uint32_t)cursor;
+    cursor += slots.size() * sizeof(SkeletonNameSlot);
+    header.stringOffset = (uint32_t)cursor;
+    header.stringSize = (uint32_t)pool.size();
+
     std::ofstream out(path, std::ios::binary);
-    MeshHeader header{ (uint32_t)vertices.size(), (uint32_t)indices.size(), mesh->mMaterialIndex };
-    out.write((char*)&header, sizeof(header));
-    out.write((char*)vertices.data(), vertices.size() * sizeof(Vertex));
-    out.write((char*)indices.data(), indices.size() * sizeof(uint32_t));
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)parents.data(), parents.size() * sizeof(int32_t));
+    out.write((const char*)names.data(), names.size() * sizeof(uint32_t));
+    PadTo(out, SKELETON_SIMD_ALIGNMENT);
+    for (const auto* m : { &inverseBind, &bindLocal, &bindGlobal }) out.write((const char*)m->data(), m->size() * sizeof(float));
+    out.write((const char*)slots.data(), slots.size() * sizeof(SkeletonNameSlot));
+    out.write(pool.data(), (std::streamsize)pool.size());
 }
 
-void processSkeleton(const aiScene* scene, const std::string& outDir, std::map<std::string, unsigned>& boneMap, std::map<std::string, unsigned>& finalBoneMap) {
+std::string processSkeleton(const aiScene* scene, const std::string& outDir, std::map<std::string, unsigned>& boneMap, std::map<std::string, unsigned>& finalBoneMap, std::vector<SkeletonBone>& skeleton) {
     if (boneMap.empty()) {
-        json j;
-        j["bones"] = json::array();
-        std::ofstream out(outDir + "/skeleton.json");
-        out << j.dump(2);
-        return;
+        WriteSkeletonFile(outDir + "/skeleton.bin", skeleton);
+        return "skeleton.bin";
     }
     std::unordered_map<std::string, const aiNode*> nodeMap;
     BuildNodeMap(scene->mRootNode, nodeMap);
@@ -209,9 +2150,20 @@ void processSkeleton(const aiScene* scene, const std::string& outDir, std::map<s
             }
         }
         aiMatrix4x4 off;
-        FindBoneOffset(scene, kv.first, off);
-        unsortedBones.push_back({ kv.first, kv.second, parentId, off });
+        unsigned mesh = 0;
+        FindBoneOffset(scene, kv.first, off, &mesh);
+        unsortedBones.push_back({ kv.first, kv.second, parentId, off, mesh });
     }
+    // 每个网格第一个引用它的节点的世界变换 (未被引用为单位矩阵), 用于把根骨骼的动画换到网格空间
+    std::vector<FlatNode> flat;
+    FlattenNodes(scene->mRootNode, -1, flat);
+    std::vector<aiMatrix4x4> meshWorld(scene->mNumMeshes);
+    std::vector<bool> meshPlaced(scene->mNumMeshes, false);
+    for (const FlatNode& f : flat)
+        for (unsigned k = 0; k < f.node->mNumMeshes; ++k) {
+            unsigned m = f.node->mMeshes[k];
+            if (m < meshPlaced.size() && !meshPlaced[m]) { meshPlaced[m] = true; meshWorld[m] = f.world; }
+        }
     std::vector<TempBoneInfo> sortedBones;
     std::vector<int> newIndices(boneMap.size());
     std::vector<bool> added(boneMap.size(), false);
@@ -227,8 +2179,6 @@ void processSkeleton(const aiScene* scene, const std::string& outDir, std::map<s
             }
         }
     }
-    json j;
-    j["bones"] = json::array();
     for (size_t i = 0; i < sortedBones.size(); ++i) {
         auto& bone = sortedBones[i];
         finalBoneMap[bone.name] = static_cast<unsigned int>(i);
@@ -239,101 +2189,236 @@ void processSkeleton(const aiScene* scene, const std::string& outDir, std::map<s
         finalOffsetMatrix.a4 *= G_SCALE_FACTOR;
         finalOffsetMatrix.b4 *= G_SCALE_FACTOR;
         finalOffsetMatrix.c4 *= G_SCALE_FACTOR;
-        json jb;
-        jb["id"] = static_cast<unsigned int>(i);
-        jb["name"] = bone.name;
-        jb["parentId"] = bone.parentIndex;
-        jb["offset"] = MatrixToJson(finalOffsetMatrix);
-        j["bones"].push_back(jb);
-    }
-    std::ofstream out(outDir + "/skeleton.json");
-    out << j.dump(2);
+        SkeletonBone sb{ bone.name, bone.parentIndex, finalOffsetMatrix, aiMatrix4x4(), aiMatrix4x4(), aiMatrix4x4(), {} };
+        if (bone.parentIndex != -1) {
+            sb.bindLocal = skeleton[bone.parentIndex].offset * aiMatrix4x4(finalOffsetMatrix).Inverse();
+        }
+        else {
+            // 根骨骼: 绑定姿态直接取 offset 的逆 (网格空间), 不依赖场景当前姿态; 祖先变换单独记录供动画使用,
+            // 并左乘网格节点世界变换的逆, 使有动画的根与静止的根同在网格空间 (静止姿态的蒙皮矩阵为单位矩阵)
+            sb.bindLocal = aiMatrix4x4(finalOffsetMatrix).Inverse();
+            if (bone.mesh < meshWorld.size()) sb.meshInverse = aiMatrix4x4(meshWorld[bone.mesh]).Inverse();
+            auto itN = nodeMap.find(bone.name);
+            for (const aiNode* p = itN != nodeMap.end() ? itN->second->mParent : nullptr; p; p = p->mParent) {
+                aiMatrix4x4 local = p->mTransformation;
+                local.a4 *= G_SCALE_FACTOR;
+                local.b4 *= G_SCALE_FACTOR;
+                local.c4 *= G_SCALE_FACTOR;
+                sb.ancestorNodes.insert(sb.ancestorNodes.begin(), { p->mName.C_Str(), local });
+                sb.ancestors = local * sb.ancestors;
+            }
+            sb.ancestors = sb.meshInverse * sb.ancestors;
+        }
+        skeleton.push_back(sb);
+    }
+    WriteSkeletonFile(outDir + "/skeleton.bin", skeleton);
+    return "skeleton.bin";
 }
 
-void processAnimation(unsigned idx, const aiAnimation* anim, const std::string& outDir) {
+// 返回写出的文件: anim_N.anim 与烘焙出的纹理
+std::vector<std::string> processAnimation(unsigned idx, AnimClip clip, const std::string& outDir, const std::map<std::string, BonePose>* additiveRef,
+                                          const std::vector<SkeletonBone>& skeleton, const BakeTarget* bakeTarget, const aiMatrix4x4& rootMotionParent) {
     json j;
-    std::string name = anim->mName.C_Str();
-    if (name.empty()) name = "anim_" + std::to_string(idx);
-    j["name"] = name;
-    j["duration"] = anim->mDuration;
-    j["ticksPerSecond"] = (anim->mTicksPerSecond > 0.0 ? anim->mTicksPerSecond : 30.0);
+    std::vector<std::string> written;
+    if (!g_options.rootMotionBone.empty()) {
+        json rm = ExtractRootMotion(clip, g_options.rootMotionBone, g_options.rootMotionInPlace, g_options.sampleRate, rootMotionParent);
+        if (!rm.is_null()) j["rootMotion"] = rm;
+    }
+    if (additiveRef) {
+        MakeAdditive(clip, *additiveRef);
+        j["additive"] = true;
+        if (g_options.additiveRefClip < 0) j["additiveReference"] = "bind";
+        else j["additiveReference"] = { {"clip", g_options.additiveRefClip}, {"frame", g_options.additiveRefFrame} };
+    }
+    else if (g_options.bakeSkinning && !skeleton.empty()) {
+        j["baked"] = BakeSkinningTexture(idx, clip, skeleton, bakeTarget, outDir);
+        for (const char* key : { "skinTexture", "vertexTexture" })
+            if (j["baked"].contains(key)) written.push_back(j["baked"][key].get<std::string>());
+    }
+    j["name"] = clip.name;
+    j["duration"] = clip.duration;
+    j["ticksPerSecond"] = clip.ticksPerSecond;
+    if (clip.loop) j["loop"] = true;
     j["channels"] = json::array();
-    for (unsigned c = 0; c < anim->mNumChannels; ++c) {
-        const aiNodeAnim* ch = anim->mChannels[c];
+    for (const auto& ch : clip.channels) {
         json jc;
-        jc["bone"] = ch->mNodeName.C_Str();
+        jc["bone"] = ch.bone;
         jc["posKeys"] = json::array();
-        for (unsigned k = 0; k < ch->mNumPositionKeys; ++k) {
-            const auto& pk = ch->mPositionKeys[k];
+        for (const auto& pk : ch.posKeys) {
             jc["posKeys"].push_back({ {"t",pk.mTime}, {"x",pk.mValue.x * G_SCALE_FACTOR}, {"y",pk.mValue.y * G_SCALE_FACTOR}, {"z",pk.mValue.z * G_SCALE_FACTOR} });
         }
         jc["rotKeys"] = json::array();
-        for (unsigned k = 0; k < ch->mNumRotationKeys; ++k) {
-            const auto& rk = ch->mRotationKeys[k];
+        for (const auto& rk : ch.rotKeys) {
             jc["rotKeys"].push_back({ {"t",rk.mTime},{"x",rk.mValue.x},{"y",rk.mValue.y},{"z",rk.mValue.z},{"w",rk.mValue.w} });
         }
         jc["scaleKeys"] = json::array();
-        for (unsigned k = 0; k < ch->mNumScalingKeys; ++k) {
-            const auto& sk = ch->mScalingKeys[k];
+        for (const auto& sk : ch.scaleKeys) {
             jc["scaleKeys"].push_back({ {"t",sk.mTime},{"x",sk.mValue.x},{"y",sk.mValue.y},{"z",sk.mValue.z} });
         }
         j["channels"].push_back(jc);
     }
-    std::ofstream out(outDir + "/anim_" + std::to_string(idx) + ".anim");
+    written.push_back("anim_" + std::to_string(idx) + ".anim");
+    std::ofstream out(outDir + "/" + written.back());
     out << j.dump(2);
+    return written;
 }
 
-void processMaterial(unsigned int idx, const aiMaterial* mat, const aiScene* scene, const std::string& outDir)
+// 纹理槽先记为 TextureTable 的下标, 纹理处理完成后由 writeMaterialTable 换成文件名
+json processMaterial(const aiMaterial* mat, TextureTable& textures)
 {
     json j;
     aiColor4D diffuseColor;
     if (AI_SUCCESS == aiGetMaterialColor(mat, AI_MATKEY_COLOR_DIFFUSE, &diffuseColor)) { j["diffuseColor"] = { diffuseColor.r, diffuseColor.g, diffuseColor.b, diffuseColor.a }; }
     else { j["diffuseColor"] = { 1.0f, 1.0f, 1.0f, 1.0f }; }
-    aiString texturePath_ai;
-    if (AI_SUCCESS == mat->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath_ai)) {
-        std::string texturePath = texturePath_ai.C_Str();
-        if (texturePath.rfind('*', 0) == 0) {
-            int textureIndex = std::stoi(texturePath.substr(1));
-            if (scene && textureIndex < (int)scene->mNumTextures) {
-                const aiTexture* embeddedTexture = scene->mTextures[textureIndex];
-                std::string extension = "png"; if (embeddedTexture->achFormatHint[0] != 0) { extension = embeddedTexture->achFormatHint; }
-                std::string outputTextureFilename = "texture_" + std::to_string(idx) + "." + extension;
-                if (embeddedTexture->mHeight == 0) {
-                    std::ofstream textureFile(outDir + "/" + outputTextureFilename, std::ios::binary);
-                    textureFile.write(reinterpret_cast<const char*>(embeddedTexture->pcData), embeddedTexture->mWidth);
-                    textureFile.close();
-                    j["diffuseTexture"] = outputTextureFilename;
-                }
-            }
+    for (const TextureSlot& slot : TEXTURE_SLOTS) {
+        for (aiTextureType type : slot.types) {
+            aiString texturePath_ai;
+            if (type == aiTextureType_NONE || AI_SUCCESS != mat->GetTexture(type, 0, &texturePath_ai)) continue;
+            j[slot.key] = textures.request(texturePath_ai.C_Str(), slot);
+            break;
         }
-        else { std::filesystem::path p(texturePath); j["diffuseTexture"] = p.filename().string(); }
     }
-    std::string path = outDir + "/material_" + std::to_string(idx) + ".material.json";
-    std::ofstream out(path);
-    out << j.dump(4);
+    return j;
 }
 
-void createSceneFile(const aiScene* scene, const std::string& outDir) {
-    json j;
-    j["mesh_count"] = scene->mNumMeshes;
-    j["material_count"] = scene->mNumMaterials;
-    j["animation_count"] = scene->mNumAnimations;
-    j["meshes"] = json::array();
-    for (unsigned i = 0; i < scene->mNumMeshes; ++i) {
-        json m;
-        m["file"] = "mesh_" + std::to_string(i) + ".mesh";
-        m["materialIndex"] = scene->mMeshes[i]->mMaterialIndex;
-        j["meshes"].push_back(m);
-    }
-    j["materials"] = json::array();
+// 只有名字不同的材质合并为一个 (纹理已在 TextureTable 中去重, 属性相同即 json 相同); remap[源材质下标] = 输出材质下标
+std::vector<MaterialEntry> collectMaterials(const aiScene* scene, TextureTable& textures, std::vector<unsigned>& remap)
+{
+    std::vector<MaterialEntry> materials;
+    std::unordered_map<std::string, unsigned> seen;
+    remap.clear();
     for (unsigned i = 0; i < scene->mNumMaterials; ++i) {
-        j["materials"].push_back("material_" + std::to_string(i) + ".material.json");
+        json props = processMaterial(scene->mMaterials[i], textures);
+        auto inserted = seen.emplace(props.dump(), (unsigned)materials.size());
+        if (inserted.second) materials.push_back({ scene->mMaterials[i]->GetName().C_Str(), std::move(props) });
+        remap.push_back(inserted.first->second);
+    }
+    if (materials.size() < scene->mNumMaterials)
+        logln("[Info] 材质去重: " + std::to_string(scene->mNumMaterials) + " -> " + std::to_string(materials.size()));
+    return materials;
+}
+
+// 所有材质写入一个 materials.bin: 记录表 + 去重字符串池, 运行时一次映射即可读取 (见 ModelReader.h 的 MaterialTableView)
+std::string writeMaterialTable(const std::vector<MaterialEntry>& materials, const TextureTable& textures, const std::string& outDir)
+{
+    static_assert(sizeof(TEXTURE_SLOTS) / sizeof(TEXTURE_SLOTS[0]) == MATERIAL_TEXTURE_SLOT_COUNT, "TEXTURE_SLOTS 与 MaterialTextureSlot 不一致");
+    std::string pool;
+    std::unordered_map<std::string, uint32_t> poolOffsets;
+    auto intern = [&](const std::string& str) {
+        auto it = poolOffsets.find(str);
+        if (it != poolOffsets.end()) return it->second;
+        uint32_t offset = (uint32_t)pool.size();
+        pool.append(str).push_back('\0');
+        poolOffsets.emplace(str, offset);
+        return offset;
+    };
+
+    std::vector<MaterialRecord> records;
+    for (const MaterialEntry& m : materials) {
+        MaterialRecord r;
+        r.name = m.name.empty() ? MATERIAL_NO_STRING : intern(m.name);
+        for (int c = 0; c < 4; ++c) r.diffuseColor[c] = m.props["diffuseColor"][c].get<float>();
+        for (uint32_t t = 0; t < MATERIAL_TEXTURE_SLOT_COUNT; ++t) {
+            r.textures[t] = MATERIAL_NO_STRING;
+            if (!m.props.contains(TEXTURE_SLOTS[t].key)) continue;
+            const std::string& file = textures.jobs[m.props[TEXTURE_SLOTS[t].key].get<size_t>()].output;
+            if (!file.empty()) r.textures[t] = intern(file);
+        }
+        records.push_back(r);
+    }
+
+    MaterialFileHeader header = {};
+    header.magic = MATERIAL_MAGIC;
+    header.version = MATERIAL_VERSION;
+    header.headerSize = (uint16_t)sizeof(MaterialFileHeader);
+    header.materialCount = (uint32_t)records.size();
+    header.recordOffset = (uint32_t)sizeof(MaterialFileHeader);
+    header.stringOffset = header.recordOffset + header.materialCount * (uint32_t)sizeof(MaterialRecord);
+    header.stringSize = (uint32_t)pool.size();
+    std::ofstream out(outDir + "/materials.bin", std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)records.data(), records.size() * sizeof(MaterialRecord));
+    out.write(pool.data(), (std::streamsize)pool.size());
+    return "materials.bin";
+}
+
+// nodes.bin: 前序展开的节点树, 局部 TRS 与网格引用, 布局见 ModelFormat.h
+std::string processNodes(const aiScene* scene, const std::string& outDir, const std::vector<NodeMeshRef>& sources)
+{
+    std::vector<FlatNode> flat;
+    FlattenNodes(scene->mRootNode, -1, flat);
+    std::vector<NodeRecord> records;
+    std::vector<NodeMeshRef> refs;
+    std::string pool;
+    for (const FlatNode& f : flat) {
+        NodeRecord r = {};
+        r.parent = f.parent;
+        r.name = (uint32_t)pool.size();
+        pool.append(f.node->mName.C_Str()).push_back('\0');
+        aiVector3D t, s;
+        aiQuaternion q;
+        f.local.Decompose(s, q, t);
+        r.translation[0] = t.x; r.translation[1] = t.y; r.translation[2] = t.z;
+        r.rotation[0] = q.x; r.rotation[1] = q.y; r.rotation[2] = q.z; r.rotation[3] = q.w;
+        r.scale[0] = s.x; r.scale[1] = s.y; r.scale[2] = s.z;
+        r.firstMesh = (uint32_t)refs.size();
+        for (unsigned i = 0; i < f.node->mNumMeshes; ++i) {
+            unsigned m = f.node->mMeshes[i];
+            if (m >= sources.size() || ((g_options.bakeTransforms || g_options.instanceGeometry) && !scene->mMeshes[m]->HasBones())) continue;   // 静态网格由 instances.bin 绘制
+            refs.push_back(sources[m]);
+        }
+        r.meshCount = (uint32_t)refs.size() - r.firstMesh;
+        records.push_back(r);
     }
+
+    NodeFileHeader header = {};
+    header.magic = NODE_MAGIC;
+    header.version = NODE_VERSION;
+    header.headerSize = (uint16_t)sizeof(NodeFileHeader);
+    header.nodeCount = (uint32_t)records.size();
+    header.nodeOffset = (uint32_t)sizeof(NodeFileHeader);
+    header.meshRefCount = (uint32_t)refs.size();
+    header.meshRefOffset = header.nodeOffset + header.nodeCount * (uint32_t)sizeof(NodeRecord);
+    header.stringOffset = header.meshRefOffset + header.meshRefCount * (uint32_t)sizeof(NodeMeshRef);
+    header.stringSize = (uint32_t)pool.size();
+    std::ofstream out(outDir + "/nodes.bin", std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)records.data(), records.size() * sizeof(NodeRecord));
+    out.write((const char*)refs.data(), refs.size() * sizeof(NodeMeshRef));
+    out.write(pool.data(), (std::streamsize)pool.size());
+    return "nodes.bin";
+}
+
+// instances.bin: 静态网格的实例列表, 布局见 ModelFormat.h
+std::string processInstances(const std::string& outDir, const std::vector<MeshInstance>& instances)
+{
+    InstanceFileHeader header = {};
+    header.magic = INSTANCE_MAGIC;
+    header.version = INSTANCE_VERSION;
+    header.headerSize = (uint16_t)sizeof(InstanceFileHeader);
+    header.instanceCount = (uint32_t)instances.size();
+    header.instanceOffset = (uint32_t)sizeof(InstanceFileHeader);
+    std::ofstream out(outDir + "/instances.bin", std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)instances.data(), instances.size() * sizeof(MeshInstance));
+    return "instances.bin";
+}
+
+void createSceneFile(const std::string& outDir, const std::vector<json>& meshEntries, size_t materialCount, unsigned animationCount, const json& compression) {
+    json j;
+    j["mesh_count"] = meshEntries.size();
+    j["material_count"] = materialCount;
+    j["animation_count"] = animationCount;
+    j["meshes"] = meshEntries;
+    j["materials"] = "materials.bin";
     j["animations"] = json::array();
-    for (unsigned i = 0; i < scene->mNumAnimations; ++i) {
+    for (unsigned i = 0; i < animationCount; ++i) {
         j["animations"].push_back("anim_" + std::to_string(i) + ".anim");
     }
-    j["skeleton"] = "skeleton.json";
+    j["skeleton"] = "skeleton.bin";
+    j["nodes"] = "nodes.bin";
+    if (g_options.bakeTransforms || g_options.instanceGeometry) j["instances"] = "instances.bin";
+    if (!compression.is_null()) j["compression"] = compression;
     std::ofstream out(outDir + "/scene.json");
     out << j.dump(2);
 }
\ No newline at end of file